@@ -0,0 +1,75 @@
+// EventPartitionFilter selects a deterministic subset of the events, so that
+// several jobs over the same input can share the simulation of a file.
+//
+// Each job runs with the same configuration except for `worker`, puts the
+// filter in front of larg4Main in its trigger path and writes only the
+// selected events (SelectEvents of the output module) to its own file.  The
+// outputs are merged afterwards by reading them as inputs of one art job.
+//
+// An event belongs to worker hash(run, subrun, event) % workers, so the
+// assignment does not depend on the input order or on which events were
+// processed before.  With GeometryCacheDir (LArG4DetectorService) and
+// physicsTableDir (larg4Main) set, the workers skip the GDML parsing and the
+// building of the physics tables, and read the same cached files from the
+// page cache.
+//
+// physics: {
+//   filters: { partition: { module_type: EventPartitionFilter workers: 8 worker: 0 } }
+//   simulate: [ partition, larg4Main, ... ]
+// }
+// outputs: { out: { SelectEvents: [ simulate ] ... } }
+
+#include "art/Framework/Core/EDFilter.h"
+#include "art/Framework/Core/ModuleMacros.h"
+#include "art/Framework/Principal/Event.h"
+#include "cetlib_except/exception.h"
+#include "fhiclcpp/ParameterSet.h"
+#include "messagefacility/MessageLogger/MessageLogger.h"
+
+#include "larg4/Services/Hash.h"
+
+#include <cstdint>
+
+namespace larg4 {
+
+  class EventPartitionFilter : public art::EDFilter {
+  public:
+    explicit EventPartitionFilter(fhicl::ParameterSet const& p);
+
+  private:
+    bool filter(art::Event& e) override;
+    void endJob() override;
+
+    unsigned workers_; // number of jobs sharing the input
+    unsigned worker_;  // index of this job, in [0, workers_)
+    unsigned long selected_{0};
+    unsigned long seen_{0};
+  };
+}
+
+larg4::EventPartitionFilter::EventPartitionFilter(fhicl::ParameterSet const& p)
+  : EDFilter{p}, workers_(p.get<unsigned>("workers")), worker_(p.get<unsigned>("worker"))
+{
+  if (workers_ == 0 || worker_ >= workers_) {
+    throw cet::exception("EventPartitionFilter")
+      << "worker (" << worker_ << ") must be smaller than workers (" << workers_ << ").\n";
+  }
+}
+
+bool larg4::EventPartitionFilter::filter(art::Event& e)
+{
+  ++seen_;
+  // -- the mixing spreads consecutive event numbers evenly over the workers
+  std::uint64_t const key = splitMix64(splitMix64(splitMix64(e.run()) ^ e.subRun()) ^ e.event());
+  bool const selected = key % workers_ == worker_;
+  if (selected) ++selected_;
+  return selected;
+}
+
+void larg4::EventPartitionFilter::endJob()
+{
+  mf::LogInfo("EventPartitionFilter") << "Worker " << worker_ << " of " << workers_ << " selected "
+                                      << selected_ << " of " << seen_ << " events.";
+}
+
+DEFINE_ART_MODULE(larg4::EventPartitionFilter)
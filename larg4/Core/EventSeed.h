@@ -0,0 +1,34 @@
+//=============================================================================
+// EventSeed.h:
+// Per-event seeds of the random engines of larg4 modules, so that the
+// random sequence of an event depends only on the job seed, the module label
+// and the event ID, not on which events the job processed before.
+//=============================================================================
+
+#ifndef LARG4_CORE_EVENTSEED_H
+#define LARG4_CORE_EVENTSEED_H
+
+#include "canvas/Persistency/Provenance/EventID.h"
+#include "larg4/Services/Hash.h"
+
+#include <cstdint>
+#include <string>
+
+namespace larg4 {
+
+  /// Seed for the engine of module `label` in event `id`; a fixed function of
+  /// its arguments, independent of the platform and of the standard library.
+  inline long eventSeed(std::uint64_t jobSeed, art::EventID const& id, std::string const& label)
+  {
+    std::uint64_t h = fnv1a(label);
+    h = splitMix64(h ^ jobSeed);
+    h = splitMix64(h ^ id.run());
+    h = splitMix64(h ^ id.subRun());
+    h = splitMix64(h ^ id.event());
+    // -- seeds of the art engines must lie in [1, 9E8]
+    return static_cast<long>(h % 900000000) + 1;
+  }
+
+} // namespace larg4
+
+#endif // LARG4_CORE_EVENTSEED_H
@@ -0,0 +1,71 @@
+//=============================================================================
+// HistCDF.h:
+// Sampling table of a 1D or 2D histogram for larg4SingleGen: the cumulative
+// distribution of its bins (underflow and overflow excluded), built once so
+// that a throw is a binary search.
+//=============================================================================
+
+#ifndef LARG4_CORE_HISTCDF_H
+#define LARG4_CORE_HISTCDF_H
+
+#include <algorithm>
+#include <cstddef>
+#include <vector>
+
+namespace larg4 {
+
+  struct HistCDF {
+    std::vector<double> cdf;    ///< normalized cumulative content, x bin major
+    std::vector<double> xLow;   ///< low edge of each x bin
+    std::vector<double> xWidth; ///< width of each x bin
+    std::vector<double> yLow;   ///< low edge of each y bin (2D only)
+    std::vector<double> yWidth; ///< width of each y bin (2D only)
+
+    /// Appends the (non-negative) content of the next bin, x bin major.
+    void addContent(double content)
+    {
+      cdf.push_back((cdf.empty() ? 0. : cdf.back()) + content);
+    }
+
+    /// Scales the cumulative content to 1; false if there is no content.
+    bool normalize()
+    {
+      if (cdf.empty() || !(cdf.back() > 0.)) return false;
+      double const total = cdf.back();
+      for (double& value : cdf)
+        value /= total;
+      cdf.back() = 1.;
+      return true;
+    }
+
+    /// Index of the bin picked by the uniform random number `u` in [0, 1):
+    /// the first whose cumulative content exceeds `u`, so that empty bins
+    /// are never picked.  `u` = 1 picks the last non-empty bin.
+    std::size_t bin(double u) const
+    {
+      if (!(u < 1.)) return std::lower_bound(cdf.begin(), cdf.end(), 1.) - cdf.begin();
+      return std::upper_bound(cdf.begin(), cdf.end(), u) - cdf.begin();
+    }
+
+    /// Value in the 1D bin picked by `u`, at the fraction `v` of its width.
+    double select(double u, double v) const
+    {
+      std::size_t const i = bin(u);
+      return v * xWidth[i] + xLow[i];
+    }
+
+    /// Values in the 2D bin picked by `u`, at the fractions `v` and `w` of
+    /// its x and y widths.
+    void select(double u, double v, double w, double& x, double& y) const
+    {
+      std::size_t const b = bin(u);
+      std::size_t const i = b / yLow.size();
+      std::size_t const j = b % yLow.size();
+      x = v * xWidth[i] + xLow[i];
+      y = w * yWidth[j] + yLow[j];
+    }
+  };
+
+} // namespace larg4
+
+#endif // LARG4_CORE_HISTCDF_H
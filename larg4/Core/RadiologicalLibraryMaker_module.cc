@@ -0,0 +1,118 @@
+// RadiologicalLibraryMaker builds the radiological library read by
+// RadiologicalOverlay from a larg4 job simulating one decay per event.
+//
+// The decays of one isotope are generated at rest in a volume of liquid
+// argon large enough to contain their deposits (e.g. a single-isotope
+// RadioGen in a point-like or small volume far from the walls), simulated by
+// larg4Main, and recorded by this module, which follows it in the trigger
+// path.  The deposits of an event are stored relative to the position and
+// time of the first particle of the MCTruth; events without deposits are
+// stored too, since they count for the activity.  The library is written at
+// the end of the job.
+//
+// physics: {
+//   producers: {
+//     radlib: {
+//       module_type: RadiologicalLibraryMaker
+//       Isotope: "Ar39"
+//       MCTruthLabel: "generator"
+//       SimEnergyDepositLabels: [ "larg4Main:LArG4DetectorServicevolTPCActive" ]
+//       OutputFile: "Ar39.radlib"
+//     }
+//   }
+//   simulate: [ generator, larg4Main, radlib ]
+// }
+
+#include "art/Framework/Core/EDProducer.h"
+#include "art/Framework/Core/ModuleMacros.h"
+#include "art/Framework/Principal/Event.h"
+#include "canvas/Utilities/InputTag.h"
+#include "cetlib_except/exception.h"
+#include "fhiclcpp/ParameterSet.h"
+#include "messagefacility/MessageLogger/MessageLogger.h"
+
+#include "lardataobj/Simulation/SimEnergyDeposit.h"
+#include "larg4/Services/RadiologicalLibrary.h"
+#include "nusimdata/SimulationBase/MCTruth.h"
+
+#include <string>
+#include <vector>
+
+namespace larg4 {
+
+  class RadiologicalLibraryMaker : public art::EDProducer {
+  public:
+    explicit RadiologicalLibraryMaker(fhicl::ParameterSet const& p);
+
+  private:
+    void produce(art::Event& e) override;
+    void endJob() override;
+
+    std::string isotope_;                     // name of the isotope in the library
+    art::InputTag mcTruthLabel_;              // generator of the decays
+    std::vector<art::InputTag> depositTags_;  // SimEnergyDeposits of the decays
+    std::string outputFile_;
+    std::vector<std::vector<RadiologicalLibrary::Deposit>> decays_;
+  };
+}
+
+larg4::RadiologicalLibraryMaker::RadiologicalLibraryMaker(fhicl::ParameterSet const& p)
+  : EDProducer{p}
+  , isotope_(p.get<std::string>("Isotope"))
+  , mcTruthLabel_(p.get<art::InputTag>("MCTruthLabel"))
+  , depositTags_(p.get<std::vector<art::InputTag>>("SimEnergyDepositLabels"))
+  , outputFile_(p.get<std::string>("OutputFile"))
+{
+  if (isotope_.empty() || isotope_.size() >= sizeof(RadiologicalLibrary::Isotope::name)) {
+    throw cet::exception("RadiologicalLibraryMaker") << "Invalid Isotope \"" << isotope_ << "\"\n";
+  }
+  consumes<std::vector<simb::MCTruth>>(mcTruthLabel_);
+  for (auto const& tag : depositTags_) {
+    consumes<sim::SimEnergyDepositCollection>(tag);
+  }
+}
+
+void larg4::RadiologicalLibraryMaker::produce(art::Event& e)
+{
+  auto const& mctruths = e.getProduct<std::vector<simb::MCTruth>>(mcTruthLabel_);
+  if (mctruths.empty() || mctruths.front().NParticles() == 0) {
+    mf::LogWarning("RadiologicalLibraryMaker") << "No decay in " << e.id() << ", skipped.";
+    return;
+  }
+  if (mctruths.size() > 1) {
+    throw cet::exception("RadiologicalLibraryMaker")
+      << e.id() << " has " << mctruths.size() << " MCTruth: one decay per event is expected.\n";
+  }
+  auto const& vertex = mctruths.front().GetParticle(0).Position();
+  double const t0 = vertex.T();
+
+  auto& deposits = decays_.emplace_back();
+  for (auto const& tag : depositTags_) {
+    for (auto const& sed : e.getProduct<sim::SimEnergyDepositCollection>(tag)) {
+      auto const start = sed.Start();
+      auto const end = sed.End();
+      deposits.push_back({{float(start.X() - vertex.X()),
+                           float(start.Y() - vertex.Y()),
+                           float(start.Z() - vertex.Z())},
+                          {float(end.X() - vertex.X()),
+                           float(end.Y() - vertex.Y()),
+                           float(end.Z() - vertex.Z())},
+                          float(sed.StartT() - t0),
+                          float(sed.EndT() - t0),
+                          float(sed.E()),
+                          float(sed.ScintYieldRatio()),
+                          sed.NumPhotons(),
+                          sed.NumElectrons(),
+                          sed.PdgCode()});
+    }
+  }
+}
+
+void larg4::RadiologicalLibraryMaker::endJob()
+{
+  RadiologicalLibrary::write(outputFile_, {{isotope_, decays_}});
+  mf::LogInfo("RadiologicalLibraryMaker")
+    << "Wrote " << decays_.size() << " " << isotope_ << " decays to " << outputFile_;
+}
+
+DEFINE_ART_MODULE(larg4::RadiologicalLibraryMaker)
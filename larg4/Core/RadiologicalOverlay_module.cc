@@ -0,0 +1,216 @@
+// RadiologicalOverlay adds radiological backgrounds to the events from
+// libraries of simulated decays (see RadiologicalLibraryMaker), instead of
+// simulating the decays with Geant4.
+//
+// For every TPC active volume and every source, the number of decays in the
+// time window is drawn from a Poisson distribution with mean activity x
+// volume x window.  Each decay is picked uniformly from the library of its
+// isotope and placed at a uniform random position and time, with a random
+// orientation.  Its deposits are emitted as sim::SimEnergyDeposit with
+// TrackID sim::NoParticleId, in the instance LArG4DetectorService uses for
+// the volume (DetectorServiceName + volume name, without underscores), so
+// that the downstream modules read them alongside the larg4Main deposits;
+// deposits whose midpoint lies outside the active volume are dropped.
+//
+// The libraries are memory-mapped, and the engine is reseeded in every event
+// from the job seed and the event ID, so that the overlay of an event does
+// not depend on the other events of the job.
+//
+// physics: {
+//   producers: {
+//     radiological: {
+//       module_type: RadiologicalOverlay
+//       TimeWindow: [ -1.6e6, 1.6e6 ] # ns
+//       Sources: [
+//         { Library: "Ar39.radlib" Isotope: "Ar39" Activity: 1.41e-3 }, # Bq/cm^3
+//         { Library: "Kr85.radlib" Isotope: "Kr85" Activity: 1.6e-4 }
+//       ]
+//     }
+//   }
+// }
+
+#include "art/Framework/Core/EDProducer.h"
+#include "art/Framework/Core/ModuleMacros.h"
+#include "art/Framework/Principal/Event.h"
+#include "art/Framework/Services/Registry/ServiceHandle.h"
+#include "cetlib/search_path.h"
+#include "cetlib_except/exception.h"
+#include "fhiclcpp/ParameterSet.h"
+#include "messagefacility/MessageLogger/MessageLogger.h"
+#include "nurandom/RandomUtils/NuRandomService.h"
+
+#include "larcore/CoreUtils/ServiceUtil.h"
+#include "larcore/Geometry/Geometry.h"
+#include "larcorealg/Geometry/BoxBoundedGeo.h"
+#include "larcorealg/Geometry/GeometryCore.h"
+#include "larcorealg/Geometry/TPCGeo.h"
+#include "lardataobj/Simulation/SimEnergyDeposit.h"
+#include "lardataobj/Simulation/sim.h"
+#include "larg4/Core/EventSeed.h"
+#include "larg4/Services/RadiologicalLibrary.h"
+
+#include "CLHEP/Random/RandFlat.h"
+#include "CLHEP/Random/RandPoisson.h"
+#include "CLHEP/Random/RandomEngine.h"
+
+#include "TGeoVolume.h"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace larg4 {
+
+  class RadiologicalOverlay : public art::EDProducer {
+  public:
+    explicit RadiologicalOverlay(fhicl::ParameterSet const& p);
+
+  private:
+    void produce(art::Event& e) override;
+
+    struct Source {
+      RadiologicalLibrary const* library;
+      RadiologicalLibrary::Isotope const* isotope;
+      double activity; // [Bq/cm^3]
+    };
+    struct Volume {
+      std::string instance;
+      geo::BoxBoundedGeo box;
+    };
+
+    double timeStart_; // [ns]
+    double timeEnd_;   // [ns]
+    std::map<std::string, std::unique_ptr<RadiologicalLibrary>> libraries_; // by file
+    std::vector<Source> sources_;
+    std::vector<Volume> volumes_;
+    std::vector<std::string> instances_;
+    CLHEP::HepRandomEngine& engine_;
+    rndm::NuRandomService::seed_t jobSeed_;
+  };
+}
+
+namespace {
+  // Uniformly distributed rotation, from a random unit quaternion
+  struct Rotation {
+    explicit Rotation(CLHEP::RandFlat& flat)
+    {
+      double const u1 = flat.fire(), u2 = 2. * M_PI * flat.fire(), u3 = 2. * M_PI * flat.fire();
+      double const a = std::sqrt(1. - u1), b = std::sqrt(u1);
+      double const w = a * std::sin(u2), x = a * std::cos(u2), y = b * std::sin(u3),
+                   z = b * std::cos(u3);
+      m = {{{1. - 2. * (y * y + z * z), 2. * (x * y - z * w), 2. * (x * z + y * w)},
+            {2. * (x * y + z * w), 1. - 2. * (x * x + z * z), 2. * (y * z - x * w)},
+            {2. * (x * z - y * w), 2. * (y * z + x * w), 1. - 2. * (x * x + y * y)}}};
+    }
+
+    geo::Point_t apply(geo::Point_t const& origin, float const (&v)[3]) const
+    {
+      return {origin.X() + m[0][0] * v[0] + m[0][1] * v[1] + m[0][2] * v[2],
+              origin.Y() + m[1][0] * v[0] + m[1][1] * v[1] + m[1][2] * v[2],
+              origin.Z() + m[2][0] * v[0] + m[2][1] * v[1] + m[2][2] * v[2]};
+    }
+
+    std::array<std::array<double, 3>, 3> m;
+  };
+}
+
+larg4::RadiologicalOverlay::RadiologicalOverlay(fhicl::ParameterSet const& p)
+  : EDProducer{p}, engine_(createEngine(0))
+{
+  auto const window = p.get<std::vector<double>>("TimeWindow");
+  if (window.size() != 2 || !(window[1] > window[0])) {
+    throw cet::exception("RadiologicalOverlay") << "TimeWindow must be [start, end] in ns.\n";
+  }
+  timeStart_ = window[0];
+  timeEnd_ = window[1];
+
+  cet::search_path sp{"FW_SEARCH_PATH"};
+  for (auto const& source : p.get<std::vector<fhicl::ParameterSet>>("Sources")) {
+    auto const libraryName = source.get<std::string>("Library");
+    auto& library = libraries_[libraryName];
+    if (!library) {
+      std::string fullName;
+      if (!sp.find_file(libraryName, fullName)) {
+        throw cet::exception("RadiologicalOverlay") << "Cannot find library " << libraryName;
+      }
+      library = std::make_unique<RadiologicalLibrary>(fullName);
+    }
+    sources_.push_back({library.get(),
+                        &library->isotope(source.get<std::string>("Isotope")),
+                        source.get<double>("Activity")});
+  }
+
+  // -- the instance names follow LArG4DetectorService::instanceName()
+  auto const serviceName = p.get<std::string>("DetectorServiceName", "LArG4DetectorService");
+  auto const& geom = *lar::providerFrom<geo::Geometry>();
+  for (geo::TPCGeo const& tpc : geom.Iterate<geo::TPCGeo>()) {
+    std::string instance = serviceName + tpc.ActiveVolume()->GetName();
+    instance.erase(std::remove(instance.begin(), instance.end(), '_'), instance.end());
+    if (std::find(instances_.begin(), instances_.end(), instance) == instances_.end()) {
+      instances_.push_back(instance);
+      produces<sim::SimEnergyDepositCollection>(instance);
+    }
+    volumes_.push_back({instance, tpc.ActiveBoundingBox()});
+  }
+
+  jobSeed_ = art::ServiceHandle<rndm::NuRandomService>()->registerAndSeedEngine(
+    engine_, "HepJamesRandom", p, "Seed");
+}
+
+void larg4::RadiologicalOverlay::produce(art::Event& e)
+{
+  engine_.setSeed(eventSeed(jobSeed_, e.id(), moduleDescription().moduleLabel()), 0);
+  CLHEP::RandFlat flat{engine_};
+  CLHEP::RandPoisson poisson{engine_};
+
+  std::map<std::string, sim::SimEnergyDepositCollection> deposits;
+  for (auto const& instance : instances_) {
+    deposits[instance];
+  }
+  double const window = (timeEnd_ - timeStart_) * 1e-9; // [s]
+  std::size_t nDecays = 0;
+  for (auto const& volume : volumes_) {
+    auto const& box = volume.box;
+    double const cm3 = box.SizeX() * box.SizeY() * box.SizeZ();
+    auto& collection = deposits[volume.instance];
+    for (auto const& source : sources_) {
+      long const n = poisson.fire(source.activity * cm3 * window);
+      nDecays += n;
+      for (long i = 0; i < n; ++i) {
+        auto const decay =
+          source.library->decay(*source.isotope, flat.fireInt(source.isotope->nDecays));
+        geo::Point_t const vertex{flat.fire(box.MinX(), box.MaxX()),
+                                  flat.fire(box.MinY(), box.MaxY()),
+                                  flat.fire(box.MinZ(), box.MaxZ())};
+        double const t0 = flat.fire(timeStart_, timeEnd_);
+        Rotation const rotation{flat};
+        for (auto d = decay.begin; d != decay.end; ++d) {
+          geo::Point_t const start = rotation.apply(vertex, d->start);
+          geo::Point_t const end = rotation.apply(vertex, d->end);
+          if (!box.ContainsPosition(start + (end - start) / 2.)) continue;
+          collection.emplace_back(d->numPhotons,
+                                  d->numElectrons,
+                                  d->scintYieldRatio,
+                                  d->edep,
+                                  start,
+                                  end,
+                                  t0 + d->startT,
+                                  t0 + d->endT,
+                                  sim::NoParticleId,
+                                  d->pdg,
+                                  sim::NoParticleId);
+        }
+      }
+    }
+  }
+  mf::LogDebug("RadiologicalOverlay") << "Overlaid " << nDecays << " decays on " << e.id();
+  for (auto& [instance, collection] : deposits) {
+    e.put(std::make_unique<sim::SimEnergyDepositCollection>(std::move(collection)), instance);
+  }
+}
+
+DEFINE_ART_MODULE(larg4::RadiologicalOverlay)
@@ -0,0 +1,47 @@
+//=============================================================================
+// SubEventRanges.h:
+// Grouping of the MCTruth objects of an art event into the Geant4 events
+// ("sub-events") tracked one after the other by larg4Main.
+//=============================================================================
+
+#ifndef LARG4_CORE_SUBEVENTRANGES_H
+#define LARG4_CORE_SUBEVENTRANGES_H
+
+#include <cstddef>
+#include <limits>
+#include <utility>
+#include <vector>
+
+namespace larg4 {
+
+  /// Ranges [first, last) of MCTruth indices tracked in one Geant4 event each,
+  /// given the number of primaries of every MCTruth, in input order. A range
+  /// is closed before the MCTruth that would take it above `maxPrimaries`;
+  /// MCTruth objects are never split, so that all particles of an interaction
+  /// share one Geant4 event. The last range is open (last = max size_t), and
+  /// `maxPrimaries` 0 puts everything in one range.
+  inline std::vector<std::pair<std::size_t, std::size_t>> subEventRanges(
+    std::vector<std::size_t> const& primaries,
+    std::size_t maxPrimaries)
+  {
+    constexpr auto all = std::numeric_limits<std::size_t>::max();
+    if (maxPrimaries == 0) { return {{0, all}}; }
+
+    std::vector<std::pair<std::size_t, std::size_t>> result;
+    std::size_t first = 0;
+    std::size_t inRange = 0;
+    for (std::size_t index = 0; index < primaries.size(); ++index) {
+      if (inRange > 0 && inRange + primaries[index] > maxPrimaries) {
+        result.emplace_back(first, index);
+        first = index;
+        inRange = 0;
+      }
+      inRange += primaries[index];
+    }
+    result.emplace_back(first, all);
+    return result;
+  }
+
+} // namespace larg4
+
+#endif // LARG4_CORE_SUBEVENTRANGES_H
@@ -23,6 +23,9 @@
 #include "artg4tk/geantInit/ArtG4StackingAction.hh"
 #include "artg4tk/geantInit/ArtG4SteppingAction.hh"
 #include "artg4tk/geantInit/ArtG4TrackingAction.hh"
+#include "larg4/Core/EventSeed.h"
+#include "larg4/Core/SubEventRanges.h"
+#include "larg4/Services/Hash.h"
 #include "larg4/pluginActions/MCTruthEventAction_service.h" // combined actions.
 #include "larg4/pluginActions/ParticleListAction_service.h" // combined actions.
 
@@ -39,18 +42,65 @@
 #include "nug4/ParticleNavigation/ParticleList.h"
 #include "nurandom/RandomUtils/NuRandomService.h"
 // Geant4 includes
+#include "Geant4/G4Element.hh"
+#include "Geant4/G4EmParameters.hh"
+#include "Geant4/G4FastSimulationPhysics.hh"
+#include "Geant4/G4Material.hh"
+#include "Geant4/G4ProductionCuts.hh"
+#include "Geant4/G4Region.hh"
+#include "Geant4/G4RegionStore.hh"
 #include "Geant4/G4UImanager.hh"
 #include "Geant4/G4UIterminal.hh"
+#include "Geant4/G4VModularPhysicsList.hh"
+#include "Geant4/G4VPhysicsConstructor.hh"
+#include "Geant4/G4Version.hh"
+// CLHEP includes
+#include "CLHEP/Random/RandomEngine.h"
 // C++ includes
 #include <atomic>
+#include <cstdint>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <future>
+#include <iomanip>
 #include <map>
 #include <memory>
 #include <set>
+#include <sstream>
 #include <string>
+#include <typeinfo>
+#include <utility>
 #include <vector>
 
+#include <unistd.h>
+
 using MCTruthCollection = std::vector<simb::MCTruth>;
 
+namespace {
+  // Reads the file, or all files below the directory, so that later reads
+  // by Geant4 are served from the page cache.
+  void prefetch(std::string const& path)
+  {
+    namespace fs = std::filesystem;
+    std::error_code ec;
+    std::vector<fs::path> files;
+    if (fs::is_directory(path, ec)) {
+      for (fs::recursive_directory_iterator it{path, ec}, end; !ec && it != end; it.increment(ec)) {
+        if (it->is_regular_file(ec)) files.push_back(it->path());
+      }
+    }
+    else if (fs::is_regular_file(path, ec)) {
+      files.push_back(path);
+    }
+    std::vector<char> buffer(1 << 20);
+    for (auto const& file : files) {
+      std::ifstream in{file, std::ios::binary};
+      while (in.read(buffer.data(), buffer.size())) {}
+    }
+  }
+}
+
 namespace larg4 {
 
   // Define the producer
@@ -67,6 +117,16 @@ namespace larg4 {
 
     std::vector<art::Handle<MCTruthCollection>> inputCollections(art::Event const& e) const;
 
+    // Ranges of MCTruth indices (counted over all input collections) tracked
+    // as one Geant4 event each
+    std::vector<std::pair<std::size_t, std::size_t>> subEventRanges(
+      std::vector<art::Handle<MCTruthCollection>> const& mclists) const;
+
+    // Name of the stored physics tables for the current physics list,
+    // production cuts, materials, EM parameters and Geant4 data sets
+    std::string physicsTableKey() const;
+    void storePhysicsTables(std::string const& location) const;
+
     // Our custom run manager
     static std::unique_ptr<artg4tk::ArtG4RunManager> runManager_;
 
@@ -80,6 +140,13 @@ namespace larg4 {
     // than a long can hold.
     long seed_;
 
+    // Whether the G4Engine is reseeded at the start of every event from the
+    // seed above, the event ID and the module label, so that the result of an
+    // event does not depend on which events were processed before it.
+    bool perEventSeed_;
+    CLHEP::HepRandomEngine* g4Engine_{nullptr};
+    rndm::NuRandomService::seed_t jobSeed_{};
+
     // Directory path(s), in colon-delimited list, in which we should look for
     // macros, or the name of an environment variable containing that path.
     // Contains only the $FW_SEARCH_PATH by default, which contains some basic
@@ -93,9 +160,37 @@ namespace larg4 {
     // Name of the Geant4 macro file, if provided
     std::string g4MacroFile_;
 
+    // Directory where physics tables are stored on first use and retrieved
+    // from by later jobs with the same physics list, cuts, materials,
+    // EM parameters and Geant4 data sets.
+    // Empty (the default) to always build the tables.
+    std::string physicsTableDir_;
+
+    // Files or directories (e.g. Geant4 data sets) read in the background
+    // from beginJob on, so that initialization does not wait for them. The
+    // stored physics tables of the current setup are read ahead separately.
+    std::vector<std::string> prefetchPaths_;
+
+    // Particles for which the fast simulation models attached to regions of
+    // the geometry (e.g. FastMuonTransport in LArG4DetectorService) apply
+    std::vector<std::string> fastSimulationParticles_;
+
+    // Work started at beginJob on background threads and joined in beginRun
+    // where its result is needed. Only work which does not touch Geant4 state
+    // is done this way: Geant4 builds geometry and particles into per-thread
+    // data which must belong to the thread driving the run.
+    std::future<std::string> macroLocation_;
+    std::vector<std::future<void>> prefetches_;
+
     // Input tags used to specify which MCTruth collections to use during G4
     std::vector<art::InputTag> inputCollectionTags_;
 
+    // Maximum number of primaries tracked in one Geant4 event. Events with
+    // more are split into sub-events of whole MCTruth objects, tracked one
+    // after the other and merged into one set of products. 0 (the default)
+    // tracks all primaries of the art event in one Geant4 event.
+    std::size_t subEventPrimaries_;
+
     // Boolean to determine whether we pause execution after each event
     // If it's true, then we do. Otherwise, we pause only after all events
     // have been produced.
@@ -133,10 +228,15 @@ std::atomic<int> larg4::larg4Main::processingRun_{0};
 larg4::larg4Main::larg4Main(fhicl::ParameterSet const& p)
   : EDProducer{p}
   , seed_(p.get<long>("seed", -1))
+  , perEventSeed_(p.get<bool>("perEventSeed", false))
   , macroPath_(p.get<std::string>("macroPath", "FW_SEARCH_PATH"))
   , pathFinder_(macroPath_)
   , g4MacroFile_(p.get<std::string>("visMacro", "larg4.mac"))
+  , physicsTableDir_(p.get<std::string>("physicsTableDir", ""))
+  , prefetchPaths_(p.get<std::vector<std::string>>("prefetchPaths", {}))
+  , fastSimulationParticles_(p.get<std::vector<std::string>>("fastSimulationParticles", {}))
   , inputCollectionTags_{p.get<std::vector<art::InputTag>>("inputCollections", {})}
+  , subEventPrimaries_(p.get<std::size_t>("subEventPrimaries", 0))
   , rmvlevel_(p.get<int>("rmvlevel", 0))
   , uiAtBeginRun_(p.get<bool>("uiAtBeginRun", false))
   , afterEvent_(p.get<std::string>("afterEvent", "pass"))
@@ -175,8 +275,9 @@ larg4::larg4Main::larg4Main(fhicl::ParameterSet const& p)
   }
   // Set up the random number engine.
   // -- D.R.: Use the NuRandomService engine for additional control over the seed generation policy
-  (void)art::ServiceHandle<rndm::NuRandomService>()->registerAndSeedEngine(
-    createEngine(0, "G4Engine"), "G4Engine", p, "seed");
+  g4Engine_ = &createEngine(0, "G4Engine");
+  jobSeed_ = art::ServiceHandle<rndm::NuRandomService>()->registerAndSeedEngine(
+    *g4Engine_, "G4Engine", p, "seed");
 
   // Handle the afterEvent setting
   if (afterEvent_ == "ui") { uiAtEndEvent_ = true; }
@@ -193,6 +294,17 @@ larg4::larg4Main::~larg4Main()
 void larg4::larg4Main::beginJob()
 {
   mf::LogDebug("Main_Run_Manager") << "In begin job";
+
+  // Start the work beginRun depends on, but which needs no Geant4 state.
+  macroLocation_ = std::async(std::launch::async, [this] {
+    std::string location;
+    pathFinder_.find_file(g4MacroFile_, location);
+    return location;
+  });
+  for (auto const& path : prefetchPaths_) {
+    prefetches_.push_back(std::async(std::launch::async, prefetch, path));
+  }
+
   if (runManager_) { return; }
   runManager_.reset(new artg4tk::ArtG4RunManager);
 }
@@ -203,7 +315,20 @@ void larg4::larg4Main::beginRun(art::Run& r)
 
   // Get the physics list and pass it to Geant and initialize the list if necessary
   art::ServiceHandle<artg4tk::PhysicsListHolderService const> physicsListHolder;
-  runManager_->SetUserInitialization(physicsListHolder->makePhysicsList());
+  auto physicsList = physicsListHolder->makePhysicsList();
+  if (!fastSimulationParticles_.empty()) {
+    auto modular = dynamic_cast<G4VModularPhysicsList*>(physicsList);
+    if (!modular) {
+      throw cet::exception("larg4Main")
+        << "fastSimulationParticles requires a modular physics list.\n";
+    }
+    auto fastSimulation = new G4FastSimulationPhysics();
+    for (auto const& particle : fastSimulationParticles_) {
+      fastSimulation->ActivateFastSimulation(particle);
+    }
+    modular->RegisterPhysics(fastSimulation);
+  }
+  runManager_->SetUserInitialization(physicsList);
 
   // Get all of the detectors and initialize them
   // Declare the detector construction to Geant
@@ -237,9 +362,14 @@ void larg4::larg4Main::beginRun(art::Run& r)
   //get the pointer to the User Interface manager
   UI_ = G4UImanager::GetUIpointer();
 
-  // Find the macro (or try to) along the directory path.
-  std::string macroLocation = "";
-  bool macroWasFound = pathFinder_.find_file(g4MacroFile_, macroLocation);
+  // Find the macro (or try to) along the directory path; the search was
+  // started at beginJob.
+  std::string macroLocation;
+  if (macroLocation_.valid()) { macroLocation = macroLocation_.get(); }
+  else {
+    pathFinder_.find_file(g4MacroFile_, macroLocation);
+  }
+  bool const macroWasFound = !macroLocation.empty();
   mf::LogInfo("larg4Main") << "Finding path for " << g4MacroFile_ << "...\nSearch "
                            << (macroWasFound ? "successful " : "unsuccessful ") << "and path is: \n"
                            << macroLocation;
@@ -264,13 +394,131 @@ void larg4::larg4Main::beginRun(art::Run& r)
     delete session_;
   }
 
+  // Retrieve the physics tables if an earlier job stored them for the same
+  // setup; they are otherwise built at the beginning of the run and stored.
+  // Geant4 falls back to building the tables if they cannot be retrieved.
+  std::string physicsTableLocation;
+  bool storeTables = false;
+  std::future<void> tablePrefetch;
+  if (!physicsTableDir_.empty()) {
+    physicsTableLocation = physicsTableDir_ + "/" + physicsTableKey();
+    if (std::filesystem::is_directory(physicsTableLocation)) {
+      mf::LogInfo("larg4Main") << "Retrieving physics tables from " << physicsTableLocation;
+      UI_->ApplyCommand("/run/particle/retrievePhysicsTable " + physicsTableLocation);
+      // -- only the tables of this setup, read ahead of Geant4 while it starts
+      tablePrefetch = std::async(std::launch::async, prefetch, physicsTableLocation);
+    }
+    else {
+      storeTables = true;
+    }
+  }
+
+  // The data sets are read when the run begins
+  for (auto& prefetched : prefetches_) {
+    prefetched.get();
+  }
+  prefetches_.clear();
+
   // Start the Geant run!
   runManager_->BeamOnBeginRun(r.id().run());
+  if (tablePrefetch.valid()) { tablePrefetch.get(); }
+
+  if (storeTables) { storePhysicsTables(physicsTableLocation); }
+}
+
+std::string larg4::larg4Main::physicsTableKey() const
+{
+  std::ostringstream setup;
+  setup << "G4 " << G4VERSION_NUMBER << '\n';
+
+  G4VUserPhysicsList const* physicsList = runManager_->GetUserPhysicsList();
+  setup << "list " << typeid(*physicsList).name() << '\n';
+  if (auto modular = dynamic_cast<G4VModularPhysicsList const*>(physicsList)) {
+    for (G4int i = 0; G4VPhysicsConstructor const* physics = modular->GetPhysics(i); ++i) {
+      setup << "physics " << physics->GetPhysicsName() << '\n';
+    }
+  }
+  setup << "cut " << physicsList->GetDefaultCutValue() << '\n';
+
+  for (G4Region const* region : *G4RegionStore::GetInstance()) {
+    setup << "region " << region->GetName();
+    if (G4ProductionCuts const* cuts = region->GetProductionCuts()) {
+      for (G4double const cut : cuts->GetProductionCuts()) {
+        setup << ' ' << cut;
+      }
+    }
+    auto material = region->GetMaterialIterator();
+    for (std::size_t i = 0, n = region->GetNumberOfMaterials(); i < n; ++i, ++material) {
+      setup << ' ' << (*material)->GetName();
+    }
+    setup << '\n';
+  }
+
+  for (G4Material const* material : *G4Material::GetMaterialTable()) {
+    setup << "material " << material->GetName() << ' ' << material->GetDensity() << ' '
+          << material->GetState() << ' ' << material->GetTemperature();
+    for (std::size_t i = 0, n = material->GetNumberOfElements(); i < n; ++i) {
+      setup << ' ' << material->GetElement(i)->GetName() << ' '
+            << material->GetFractionVector()[i];
+    }
+    setup << '\n';
+  }
+
+  // -- EM settings of the macro (/process/em/..., /process/eLoss/...) change
+  //    the tables, and so do the data sets, whose paths carry their versions
+  G4EmParameters::Instance()->StreamInfo(setup);
+  for (char const* dataSet : {"G4LEDATA",
+                              "G4LEVELGAMMADATA",
+                              "G4NEUTRONHPDATA",
+                              "G4PARTICLEHPDATA",
+                              "G4PARTICLEXSDATA",
+                              "G4NEUTRONXSDATA",
+                              "G4ENSDFSTATEDATA",
+                              "G4RADIOACTIVEDATA",
+                              "G4PIIDATA",
+                              "G4SAIDXSDATA",
+                              "G4ABLADATA",
+                              "G4INCLDATA",
+                              "G4REALSURFACEDATA"}) {
+    char const* path = std::getenv(dataSet);
+    setup << "data " << dataSet << ' ' << (path ? path : "") << '\n';
+  }
+
+  std::ostringstream key;
+  key << std::hex << std::setw(16) << std::setfill('0') << fnv1a(setup.str());
+  return key.str();
+}
+
+void larg4::larg4Main::storePhysicsTables(std::string const& location) const
+{
+  // Store into a job-specific directory first, so that concurrent jobs never
+  // retrieve incomplete tables.
+  namespace fs = std::filesystem;
+  std::string const tmpLocation = location + ".tmp" + std::to_string(::getpid());
+  std::error_code ec;
+  fs::create_directories(tmpLocation, ec);
+  if (!ec && UI_->ApplyCommand("/run/particle/storePhysicsTable " + tmpLocation) == 0) {
+    fs::rename(tmpLocation, location, ec);
+    if (!ec) {
+      mf::LogInfo("larg4Main") << "Stored physics tables in " << location;
+      return;
+    }
+  }
+  if (!fs::is_directory(location)) {
+    MF_LOG_WARNING("larg4Main") << "Could not store physics tables in " << location;
+  }
+  fs::remove_all(tmpLocation, ec);
 }
 
 // Produce the Geant event
 void larg4::larg4Main::produce(art::Event& e)
 {
+  if (perEventSeed_) {
+    auto const seed = larg4::eventSeed(jobSeed_, e.id(), moduleDescription().moduleLabel());
+    g4Engine_->setSeed(seed, 0);
+    mf::LogDebug("larg4Main") << "G4Engine seeded with " << seed << " for " << e.id();
+  }
+
   // The holder services need the event
   art::ServiceHandle<artg4tk::ActionHolderService>()->setCurrArtEvent(e);
   art::ServiceHandle<artg4tk::DetectorHolderService>()->setCurrArtEvent(e);
@@ -284,8 +532,14 @@ void larg4::larg4Main::produce(art::Event& e)
   auto const pid = e.getProductID<std::vector<simb::MCParticle>>();
   pla->setPtrInfo(pid, e.productGetter(pid));
 
-  runManager_->BeamOnDoOneEvent(e.id().event());
-  runManager_->BeamOnEndEvent();
+  art::ServiceHandle<larg4::MCTruthEventActionService> mcTruthAction;
+  auto const subEvents = subEventRanges(mclists);
+  for (std::size_t i = 0; i < subEvents.size(); ++i) {
+    mcTruthAction->setMCTruthRange(subEvents[i].first, subEvents[i].second);
+    pla->setSubEvent(i == 0, i + 1 == subEvents.size());
+    runManager_->BeamOnDoOneEvent(e.id().event());
+    runManager_->BeamOnEndEvent();
+  }
 
   e.put(pla->ParticleCollection());
   e.put(pla->AssnsMCTruthToMCParticle());
@@ -314,4 +568,27 @@ std::vector<art::Handle<MCTruthCollection>> larg4::larg4Main::inputCollections(
   return result;
 }
 
+std::vector<std::pair<std::size_t, std::size_t>> larg4::larg4Main::subEventRanges(
+  std::vector<art::Handle<MCTruthCollection>> const& mclists) const
+{
+  if (subEventPrimaries_ == 0) { return larg4::subEventRanges({}, 0); }
+
+  std::vector<std::size_t> primaries;
+  for (auto const& mclist : mclists) {
+    for (simb::MCTruth const& mct : *mclist) {
+      std::size_t n = 0;
+      for (int m = 0; m != mct.NParticles(); ++m) {
+        if (mct.GetParticle(m).StatusCode() == 1) ++n;
+      }
+      primaries.push_back(n);
+    }
+  }
+  auto result = larg4::subEventRanges(primaries, subEventPrimaries_);
+  if (result.size() > 1) {
+    mf::LogInfo("larg4Main") << "Tracking " << primaries.size() << " MCTruth objects in "
+                             << result.size() << " sub-events";
+  }
+  return result;
+}
+
 DEFINE_ART_MODULE(larg4::larg4Main)
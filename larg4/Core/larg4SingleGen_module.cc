@@ -8,6 +8,7 @@
 ////////////////////////////////////////////////////////////////////////
 
 // C++ includes.
+#include <algorithm>
 #include <cctype> // std::tolower()
 #include <cmath>
 #include <initializer_list>
@@ -32,6 +33,9 @@
 #include "fhiclcpp/types/Sequence.h"
 #include "messagefacility/MessageLogger/MessageLogger.h"
 
+// larg4 includes
+#include "larg4/Core/HistCDF.h"
+
 // nurandom includes
 #include "nurandom/RandomUtils/NuRandomService.h"
 
@@ -188,8 +192,12 @@ namespace evgen {
     void Sample(simb::MCTruth& mct);
     void printVecs(std::vector<std::string> const& list);
     bool PadVector(std::vector<double>& vec);
-    double SelectFromHist(const TH1& h);
-    void SelectFromHist(const TH2& h, double& x, double& y);
+
+    using HistCDF = larg4::HistCDF;
+    static HistCDF MakeCDF(const TH1& h);
+    static HistCDF MakeCDF(const TH2& h);
+    double SelectFromHist(const HistCDF& h);
+    void SelectFromHist(const HistCDF& h, double& x, double& y);
 
     /// @{
     /// @name Constants for particle type extraction mode (`ParticleSelectionMode` parameter).
@@ -238,9 +246,8 @@ namespace evgen {
     std::vector<std::string> fPHist;   ///< name of histogram of momenta
     std::vector<std::string> fThetaXzYzHist; ///< name of histogram for thetaxz/thetayz distribution
 
-    std::vector<std::unique_ptr<TH1>> hPHist; /// actual TH1 for momentum distributions
-    std::vector<std::unique_ptr<TH2>>
-      hThetaXzYzHist; /// actual TH2 for angle distributions - Xz on x axis .
+    std::vector<HistCDF> hPHist; /// sampling tables of the momentum histograms
+    std::vector<HistCDF> hThetaXzYzHist; /// sampling tables of the angle histograms - Xz on x axis
     // FYI - thetaxz and thetayz are related to standard polar angles as follows:
     // thetaxz = atan2(math.sin(theta) * cos(phi), cos(theta))
     // thetayz = asin(sin(theta) * sin(phi));
@@ -592,14 +599,14 @@ namespace evgen {
       }
       hPHist.reserve(fPHist.size());
       for (auto const& histName : fPHist) {
-        TH1* pHist = dynamic_cast<TH1*>(histFile->Get(histName.c_str()));
+        std::unique_ptr<TH1> pHist{dynamic_cast<TH1*>(histFile->Get(histName.c_str()))};
         if (!pHist) {
           throw art::Exception(art::errors::NotFound)
             << "Failed to read momentum histogram '" << histName << "' from '"
             << histFile->GetPath() << "\'";
         }
         pHist->SetDirectory(nullptr); // make it independent of the input file
-        hPHist.emplace_back(pHist);
+        hPHist.push_back(MakeCDF(*pHist));
       } // for
       break;
     default: // supported, no further action needed
@@ -615,15 +622,16 @@ namespace evgen {
       }
       hThetaXzYzHist.reserve(fThetaXzYzHist.size());
       for (auto const& histName : fThetaXzYzHist) {
-        TH2* pHist = dynamic_cast<TH2*>(histFile->Get(histName.c_str()));
+        std::unique_ptr<TH2> pHist{dynamic_cast<TH2*>(histFile->Get(histName.c_str()))};
         if (!pHist) {
           throw art::Exception(art::errors::NotFound)
             << "Failed to read direction histogram '" << histName << "' from '"
             << histFile->GetPath() << "\'";
         }
         pHist->SetDirectory(nullptr); // make it independent of the input file
-        hThetaXzYzHist.emplace_back(pHist);
-      }      // for
+        hThetaXzYzHist.push_back(MakeCDF(*pHist));
+      } // for
+      break;
     default: // supported, no further action needed
       break;
     } // switch(fAngleDist)
@@ -693,7 +701,7 @@ namespace evgen {
     double m = 0.0;
     if (fPDist == kGAUS) { p = gauss.fire(fP0[i], fSigmaP[i]); }
     else if (fPDist == kHIST) {
-      p = SelectFromHist(*(hPHist[i]));
+      p = SelectFromHist(hPHist[i]);
     }
     else { // if (fPDist == kUNIF) {
       p = fP0[i] + fSigmaP[i] * (2.0 * flat.fire() - 1.0);
@@ -741,7 +749,7 @@ namespace evgen {
     else if (fAngleDist == kHIST) { // Select thetaxz and thetayz from histogram
       double thetaxz = 0;
       double thetayz = 0;
-      SelectFromHist(*(hThetaXzYzHist[i]), thetaxz, thetayz);
+      SelectFromHist(hThetaXzYzHist[i], thetaxz, thetayz);
       thxz = (180. / M_PI) * thetaxz;
       thyz = (180. / M_PI) * thetayz;
     }
@@ -831,7 +839,7 @@ namespace evgen {
       double m = 0.0;
       if (fPDist == kGAUS) { p = gauss.fire(fP0[i], fSigmaP[i]); }
       else if (fPDist == kHIST) {
-        p = SelectFromHist(*(hPHist[i]));
+        p = SelectFromHist(hPHist[i]);
       }
       else {
         p = fP0[i] + fSigmaP[i] * (2.0 * flat.fire() - 1.0);
@@ -856,7 +864,7 @@ namespace evgen {
       else if (fAngleDist == kHIST) {
         double thetaxz = 0;
         double thetayz = 0;
-        SelectFromHist(*(hThetaXzYzHist[i]), thetaxz, thetayz);
+        SelectFromHist(hThetaXzYzHist[i], thetaxz, thetayz);
         thxz = (180. / M_PI) * thetaxz;
         thyz = (180. / M_PI) * thetayz;
       }
@@ -988,38 +996,75 @@ namespace evgen {
   }
 
   //____________________________________________________________________________
-  double larg4SingleGen::SelectFromHist(const TH1& h) // select from a 1D histogram
+  larg4SingleGen::HistCDF larg4SingleGen::MakeCDF(const TH1& h)
+  {
+    HistCDF table;
+    for (int i(1); i <= h.GetNbinsX(); ++i) {
+      double const content = h.GetBinContent(i);
+      if (content < 0.) {
+        throw art::Exception(art::errors::Configuration)
+          << "Histogram '" << h.GetName() << "' has a negative content in bin " << i << ".";
+      }
+      table.addContent(content);
+      table.xLow.push_back(h.GetBinLowEdge(i));
+      table.xWidth.push_back(h.GetBinWidth(i));
+    }
+    if (!table.normalize()) {
+      throw art::Exception(art::errors::Configuration)
+        << "Histogram '" << h.GetName() << "' has no content to sample from.";
+    }
+    return table;
+  }
+  //____________________________________________________________________________
+  larg4SingleGen::HistCDF larg4SingleGen::MakeCDF(const TH2& h)
+  {
+    HistCDF table;
+    for (int i(1); i <= h.GetNbinsX(); ++i) {
+      table.xLow.push_back(h.GetXaxis()->GetBinLowEdge(i));
+      table.xWidth.push_back(h.GetXaxis()->GetBinWidth(i));
+    }
+    for (int j(1); j <= h.GetNbinsY(); ++j) {
+      table.yLow.push_back(h.GetYaxis()->GetBinLowEdge(j));
+      table.yWidth.push_back(h.GetYaxis()->GetBinWidth(j));
+    }
+    for (int i(1); i <= h.GetNbinsX(); ++i) {
+      for (int j(1); j <= h.GetNbinsY(); ++j) {
+        double const content = h.GetBinContent(i, j);
+        if (content < 0.) {
+          throw art::Exception(art::errors::Configuration)
+            << "Histogram '" << h.GetName() << "' has a negative content in bin (" << i << ", "
+            << j << ").";
+        }
+        table.addContent(content);
+      }
+    }
+    if (!table.normalize()) {
+      throw art::Exception(art::errors::Configuration)
+        << "Histogram '" << h.GetName() << "' has no content to sample from.";
+    }
+    return table;
+  }
+  //____________________________________________________________________________
+  double larg4SingleGen::SelectFromHist(const HistCDF& h) // select from a 1D histogram
   {
     CLHEP::RandFlat flat(fEngine);
 
-    double throw_value = h.Integral() * flat.fire();
-    double cum_value(0);
-    for (int i(0); i < h.GetNbinsX() + 1; ++i) {
-      cum_value += h.GetBinContent(i);
-      if (throw_value < cum_value) { return flat.fire() * h.GetBinWidth(i) + h.GetBinLowEdge(i); }
-    }
-    return throw_value; // for some reason we've gone through all bins and failed?
+    double const throw_value = flat.fire();
+    double const xFraction = flat.fire();
+    return h.select(throw_value, xFraction);
   }
   //____________________________________________________________________________
-  void larg4SingleGen::SelectFromHist(const TH2& h,
+  void larg4SingleGen::SelectFromHist(const HistCDF& h,
                                       double& x,
                                       double& y) // select from a 2D histogram
   {
     CLHEP::RandFlat flat(fEngine);
 
-    double throw_value = h.Integral() * flat.fire();
-    double cum_value(0);
-    for (int i(0); i < h.GetNbinsX() + 1; ++i) {
-      for (int j(0); j < h.GetNbinsY() + 1; ++j) {
-        cum_value += h.GetBinContent(i, j);
-        if (throw_value < cum_value) {
-          x = flat.fire() * h.GetXaxis()->GetBinWidth(i) + h.GetXaxis()->GetBinLowEdge(i);
-          y = flat.fire() * h.GetYaxis()->GetBinWidth(j) + h.GetYaxis()->GetBinLowEdge(j);
-          return;
-        }
-      }
-    }
-    return; // for some reason we've gone through all bins and failed?
+    // -- the throws in the order of the bin, x and y
+    double const throw_value = flat.fire();
+    double const xFraction = flat.fire();
+    double const yFraction = flat.fire();
+    h.select(throw_value, xFraction, yFraction, x, y);
   }
   //____________________________________________________________________________
 
@@ -24,173 +24,203 @@
 #include "Geant4/G4VSolid.hh"
 #include "Geant4/G4VVisManager.hh"
 #include "Geant4/G4ios.hh"
+#include "cetlib_except/exception.h"
 #include <algorithm>
-#include <unordered_set>
+#include <map>
 //#define _verbose_ 1
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
 namespace larg4 {
 
-  AuxDetSD::AuxDetSD(G4String name) : G4VSensitiveDetector(name)
+  void AuxDetSDOptions::apply(std::string const& option)
   {
-    hitCollection.clear();
+    if (option == "simChannels") { simChannels = true; }
+    else if (option == "noHits") {
+      storeHits = false;
+    }
+    else {
+      throw cet::exception("AuxDetSD") << "Unknown AuxDet option: \"" << option << "\".\n"
+                                       << "Valid options are: simChannels, noHits.\n";
+    }
+  }
+
+  void AuxDetSDOptions::apply(std::vector<std::string> const& options)
+  {
+    for (auto const& option : options) {
+      apply(option);
+    }
   }
 
   //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
 
+  AuxDetSD::AuxDetSD(G4String name,
+                     AuxDetSDOptions const& options,
+                     std::size_t arenaChunkSize,
+                     std::size_t arenaHistory)
+    : G4VSensitiveDetector(name)
+    , hitCollection(arenaChunkSize, arenaHistory)
+    , sdOptions(options)
+  {}
+
+  //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
   AuxDetSD::~AuxDetSD() {}
   //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
   void AuxDetSD::Initialize(G4HCofThisEvent*)
   {
-    hitCollection.clear();
-    temphitCollection.clear();
+    hitCollection.reset();
+    hitIndex.clear();
   }
   //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
   G4bool AuxDetSD::ProcessHits(G4Step* step, G4TouchableHistory*)
   {
     G4double edep = step->GetTotalEnergyDeposit() / CLHEP::MeV;
     if (edep == 0.) return false;
+    if (generatorPolicy && !generatorPolicy->auxDetHits) return false;
     G4Track* track = step->GetTrack();
     const unsigned int trackID = track->GetTrackID();
     unsigned int ID = step->GetPreStepPoint()->GetPhysicalVolume()->GetCopyNo();
-    TempHit tmpHit = TempHit(ID,
-                             trackID,
-                             track->GetParentID(),
-                             step->IsFirstStepInVolume(),
-                             step->IsLastStepInVolume(),
-                             edep,
-                             step->GetPreStepPoint()->GetPosition().getX() / CLHEP::cm,
-                             step->GetPreStepPoint()->GetPosition().getY() / CLHEP::cm,
-                             step->GetPreStepPoint()->GetPosition().getZ() / CLHEP::cm,
-                             step->GetPreStepPoint()->GetGlobalTime() / CLHEP::ns,
-                             step->GetPostStepPoint()->GetPosition().getX() / CLHEP::cm,
-                             step->GetPostStepPoint()->GetPosition().getY() / CLHEP::cm,
-                             step->GetPostStepPoint()->GetPosition().getZ() / CLHEP::cm,
-                             step->GetPostStepPoint()->GetGlobalTime() / CLHEP::ns,
-                             step->GetPostStepPoint()->GetMomentum().getX() / CLHEP::GeV,
-                             step->GetPostStepPoint()->GetMomentum().getY() / CLHEP::GeV,
-                             step->GetPostStepPoint()->GetMomentum().getZ() / CLHEP::GeV);
-    temphitCollection.push_back(tmpHit);
+    G4StepPoint const* post = step->GetPostStepPoint();
 
-    /*
-  sim::AuxDetHit newHit = sim::AuxDetHit(ID,
-				    trackID,
-				    edep,
-				    step->GetPreStepPoint()->GetPosition().getX()/CLHEP::cm,
-				    step->GetPreStepPoint()->GetPosition().getY()/CLHEP::cm,
-				    step->GetPreStepPoint()->GetPosition().getZ()/CLHEP::cm,
-				    step->GetPreStepPoint()->GetGlobalTime()/CLHEP::ns,
-				    step->GetPostStepPoint()->GetPosition().getX()/CLHEP::cm,
-				    step->GetPostStepPoint()->GetPosition().getY()/CLHEP::cm,
-				    step->GetPostStepPoint()->GetPosition().getZ()/CLHEP::cm,
-				    step->GetPostStepPoint()->GetGlobalTime()/CLHEP::ns,
-				    step->GetPostStepPoint()->GetMomentum().getX()/CLHEP::GeV,
-				    step->GetPostStepPoint()->GetMomentum().getY()/CLHEP::GeV,
-				    step->GetPostStepPoint()->GetMomentum().getZ()/CLHEP::GeV
-				    );
-  hitCollection.push_back(newHit);
-  */
+    // -- Is this track already contributing to a hit in this copy?
+    auto it = hitIndex.find(key(ID, trackID));
+    if (it == hitIndex.end()) {
+      // -- No: if its parent contributes to a hit in this copy, the track
+      //    is folded into that hit, otherwise it starts a new one
+      auto const parent = hitIndex.find(key(ID, track->GetParentID()));
+      if (parent != hitIndex.end()) {
+        it = hitIndex.emplace(key(ID, trackID), parent->second).first;
+      }
+      else {
+        G4StepPoint const* pre = step->GetPreStepPoint();
+        hitIndex.emplace(key(ID, trackID), hitCollection.size());
+        hitCollection.emplace_back(ID,
+                                   trackID,
+                                   edep,
+                                   pre->GetPosition().getX() / CLHEP::cm,
+                                   pre->GetPosition().getY() / CLHEP::cm,
+                                   pre->GetPosition().getZ() / CLHEP::cm,
+                                   pre->GetGlobalTime() / CLHEP::ns,
+                                   post->GetPosition().getX() / CLHEP::cm,
+                                   post->GetPosition().getY() / CLHEP::cm,
+                                   post->GetPosition().getZ() / CLHEP::cm,
+                                   post->GetGlobalTime() / CLHEP::ns,
+                                   post->GetMomentum().getX() / CLHEP::GeV,
+                                   post->GetMomentum().getY() / CLHEP::GeV,
+                                   post->GetMomentum().getZ() / CLHEP::GeV);
+#if defined _verbose_
+        std::cout << " N geoID: " << ID << " track ID: " << trackID << " Edep: " << edep
+                  << std::endl;
+#endif
+        return true;
+      }
+    }
+
+    sim::AuxDetHit& hit = hitCollection[it->second];
+    hit.SetEnergyDeposited(hit.GetEnergyDeposited() + edep);
+    // -- only steps of the track that owns the hit move its exit point
+    float const exitT = post->GetGlobalTime() / CLHEP::ns;
+    if (hit.GetTrackID() == trackID && exitT) {
+      hit.SetExitX(post->GetPosition().getX() / CLHEP::cm);
+      hit.SetExitY(post->GetPosition().getY() / CLHEP::cm);
+      hit.SetExitZ(post->GetPosition().getZ() / CLHEP::cm);
+      hit.SetExitT(exitT);
+    }
+#if defined _verbose_
+    std::cout << " A geoID: " << ID << " track ID: " << trackID << " Edep: " << edep << std::endl;
+#endif
     return true;
   }
 
   void AuxDetSD::EndOfEvent(G4HCofThisEvent*)
   {
-    if (temphitCollection.size() == 0) return; // No hits so nothing to do
+    // -- Keep the product in the canonical (copy number, track ID) order; this
+    //    sorts the (few) hits, not the steps.
+    std::sort(hitCollection.begin(),
+              hitCollection.end(),
+              [](sim::AuxDetHit const& a, sim::AuxDetHit const& b) {
+                return a.GetID() < b.GetID() ||
+                       (a.GetID() == b.GetID() && a.GetTrackID() < b.GetTrackID());
+              });
 #if defined _verbose_
-    std::cout << " EndOfEvent number of temp hits: " << temphitCollection.size() << std::endl;
-    std::cout << " EndOfEvent number of aux hits: " << hitCollection.size() << std::endl;
+    std::cout << "Number of AuxDetHits: " << hitCollection.size() << std::endl;
 #endif
-    std::sort(temphitCollection.begin(), temphitCollection.end());
-    int geoId = -1;
-    int trackId = -1;
-    unsigned int counter = 0;
-    std::unordered_set<unsigned int> setofIDs;
+  } // EndOfEvent
 
-    for (auto it = temphitCollection.begin(); it != temphitCollection.end(); it++) {
-#if defined _verbose_
-      std::cout << "geoID: " << it->GetID() << " track ID: " << it->GetTrackID()
-                << " Edep: " << it->GetEnergyDeposited() << " Parent Id: " << it->GetParentID()
-                << " exit Time:  " << it->GetExitT() << " is first: " << it->IsIsfirstinVolume()
-                << " is last:  " << it->IsIslastinVolume();
-#endif
-      if (it->GetID() == geoId && trackId == it->GetTrackID()) // trackid and detector didn't change
-      {
-#if defined _verbose_
-        std::cout << " A" << std::endl;
-#endif
-        if (it->GetExitT()) // change exit vector and add to total charge
-        {
-          hitCollection[counter - 1].SetEnergyDeposited(
-            hitCollection[counter - 1].GetEnergyDeposited() + it->GetEnergyDeposited());
-          hitCollection[counter - 1].SetExitX(it->GetExitX());
-          hitCollection[counter - 1].SetExitY(it->GetExitY());
-          hitCollection[counter - 1].SetExitZ(it->GetExitZ());
-          hitCollection[counter - 1].SetExitT(it->GetExitT());
+  //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+  void AuxDetSD::SetChannel(unsigned int copyNo, unsigned int auxDetID, unsigned int sensitiveID)
+  {
+    auto const [it, inserted] = channelMap.emplace(copyNo, std::make_pair(auxDetID, sensitiveID));
+    if (!inserted && it->second != std::make_pair(auxDetID, sensitiveID)) {
+      throw cet::exception("AuxDetSD")
+        << GetName() << ": copy number " << copyNo << " is placed in both AuxDet "
+        << it->second.first << " (sensitive " << it->second.second << ") and AuxDet " << auxDetID
+        << " (sensitive " << sensitiveID << "); copy numbers must identify a channel.\n";
+    }
+  }
+
+  //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+  std::vector<sim::AuxDetSimChannel> AuxDetSD::MakeSimChannels(
+    sim::AuxDetHitCollection const& hits) const
+  {
+    std::map<std::pair<unsigned int, unsigned int>, std::vector<sim::AuxDetIDE>> channelIDEs;
+    for (auto const& hit : hits) {
+      auto const channel = channelMap.find(hit.GetID());
+      if (channel == channelMap.end()) {
+        throw cet::exception("AuxDetSD")
+          << GetName() << ": no AuxDet channel known for copy number " << hit.GetID() << ".\n";
+      }
+      sim::AuxDetIDE ide;
+      ide.trackID = hit.GetTrackID();
+      ide.energyDeposited = hit.GetEnergyDeposited();
+      ide.entryX = hit.GetEntryX();
+      ide.entryY = hit.GetEntryY();
+      ide.entryZ = hit.GetEntryZ();
+      ide.entryT = hit.GetEntryT();
+      ide.exitX = hit.GetExitX();
+      ide.exitY = hit.GetExitY();
+      ide.exitZ = hit.GetExitZ();
+      ide.exitT = hit.GetExitT();
+      ide.exitMomentumX = hit.GetExitMomentumX();
+      ide.exitMomentumY = hit.GetExitMomentumY();
+      ide.exitMomentumZ = hit.GetExitMomentumZ();
+      channelIDEs[channel->second].push_back(ide);
+    }
+
+    std::vector<sim::AuxDetSimChannel> result;
+    result.reserve(channelIDEs.size());
+    for (auto& [channel, ides] : channelIDEs) {
+      // -- one IDE per track: merge the hits of a track seen in several
+      //    copies reading out the same channel
+      std::stable_sort(ides.begin(), ides.end(), [](auto const& a, auto const& b) {
+        return a.trackID < b.trackID;
+      });
+      std::vector<sim::AuxDetIDE> merged;
+      merged.reserve(ides.size());
+      for (auto const& ide : ides) {
+        if (merged.empty() || merged.back().trackID != ide.trackID) {
+          merged.push_back(ide);
+          continue;
         }
-        else // just add to total charge
-        {
-          hitCollection[counter - 1].SetEnergyDeposited(
-            hitCollection[counter - 1].GetEnergyDeposited() + it->GetEnergyDeposited());
+        auto& last = merged.back();
+        last.energyDeposited += ide.energyDeposited;
+        if (ide.entryT < last.entryT) {
+          last.entryX = ide.entryX;
+          last.entryY = ide.entryY;
+          last.entryZ = ide.entryZ;
+          last.entryT = ide.entryT;
+        }
+        if (ide.exitT > last.exitT) {
+          last.exitX = ide.exitX;
+          last.exitY = ide.exitY;
+          last.exitZ = ide.exitZ;
+          last.exitT = ide.exitT;
+          last.exitMomentumX = ide.exitMomentumX;
+          last.exitMomentumY = ide.exitMomentumY;
+          last.exitMomentumZ = ide.exitMomentumZ;
         }
       }
-      else if (setofIDs.find(it->GetParentID()) != setofIDs.end()) {
-        setofIDs.insert(it->GetTrackID());
-#if defined _verbose_
-        std::cout << " A" << std::endl;
-#endif
-        hitCollection[counter - 1].SetEnergyDeposited(
-          hitCollection[counter - 1].GetEnergyDeposited() + it->GetEnergyDeposited());
-      }
-      else if (it->GetID() != geoId) // new Detector
-      {
-        geoId = it->GetID();
-        trackId = it->GetTrackID();
-        setofIDs.clear();
-        setofIDs.insert(it->GetTrackID());
-#if defined _verbose_
-        std::cout << " N" << std::endl;
-#endif
-        counter++;
-        hitCollection.push_back(sim::AuxDetHit(it->GetID(),
-                                               it->GetTrackID(),
-                                               it->GetEnergyDeposited(),
-                                               it->GetEntryX(),
-                                               it->GetEntryY(),
-                                               it->GetEntryZ(),
-                                               it->GetEntryT(),
-                                               it->GetExitX(),
-                                               it->GetExitY(),
-                                               it->GetExitZ(),
-                                               it->GetExitT(),
-                                               it->GetExitMomentumX(),
-                                               it->GetExitMomentumY(),
-                                               it->GetExitMomentumZ()));
-      }
-      else {
-        trackId = it->GetTrackID();
-#if defined _verbose_
-        std::cout << " N" << std::endl;
-#endif
-        counter++;
-        setofIDs.clear();
-        setofIDs.insert(it->GetTrackID());
-        hitCollection.push_back(sim::AuxDetHit(it->GetID(),
-                                               it->GetTrackID(),
-                                               it->GetEnergyDeposited(),
-                                               it->GetEntryX(),
-                                               it->GetEntryY(),
-                                               it->GetEntryZ(),
-                                               it->GetEntryT(),
-                                               it->GetExitX(),
-                                               it->GetExitY(),
-                                               it->GetExitZ(),
-                                               it->GetExitT(),
-                                               it->GetExitMomentumX(),
-                                               it->GetExitMomentumY(),
-                                               it->GetExitMomentumZ()));
-      }
+      result.emplace_back(channel.first, std::move(merged), channel.second);
     }
-#if defined _verbose_
-    std::cout << "Number of AuxDetHits: " << counter << std::endl;
-#endif
-  } // EndOfEvent
+    return result;
+  }
 } // namespace sim
@@ -1,6 +1,15 @@
 //=============================================================================
 // AuxDetSD.h: Class representing a sensitive for a thin CRT detector
 // Author: Hans Wenzel (Fermilab)
+//
+// Steps are aggregated as they arrive: a hit is keyed by the copy number of
+// the volume and the track that first deposited energy in it; secondaries
+// depositing in the same copy are folded into the hit of their ancestor.
+//
+// Optionally (SensDet value "AuxDet:simChannels") the hits are also grouped
+// into per-channel sim::AuxDetSimChannel, using a copy number -> (AuxDet,
+// sensitive AuxDet) table filled by LArG4DetectorService when the geometry
+// is built.
 //=============================================================================
 // Include guard
 #ifndef AuxDetSD_h
@@ -9,7 +18,16 @@
 #include "Geant4/G4VSensitiveDetector.hh"
 #include "larcore/Geometry/Geometry.h"
 #include "lardataobj/Simulation/AuxDetHit.h"
-#include "larg4/Services/TempHit.h"
+#include "lardataobj/Simulation/AuxDetSimChannel.h"
+#include "larg4/Services/HitArena.h"
+#include "larg4/pluginActions/GeneratorPolicy.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
 
 #if defined __clang__
 #pragma clang diagnostic push
@@ -23,18 +41,55 @@ class AuxDetHitCollection;
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
 namespace larg4 {
 
+  struct AuxDetSDOptions {
+    bool storeHits{true};    ///< produce sim::AuxDetHit ("noHits" disables)
+    bool simChannels{false}; ///< produce sim::AuxDetSimChannel ("simChannels")
+
+    /// Applies options in the form "simChannels", "noHits"; throws on unknown options.
+    void apply(std::string const& option);
+    void apply(std::vector<std::string> const& options);
+  };
+
   class AuxDetSD : public G4VSensitiveDetector {
   public:
-    AuxDetSD(G4String name);
+    AuxDetSD(G4String name,
+             AuxDetSDOptions const& options = {},
+             std::size_t arenaChunkSize = 4096,
+             std::size_t arenaHistory = 8);
     virtual ~AuxDetSD();
     void Initialize(G4HCofThisEvent*);
     void EndOfEvent(G4HCofThisEvent*);
     G4bool ProcessHits(G4Step*, G4TouchableHistory*);
-    const sim::AuxDetHitCollection& GetHits() const { return hitCollection; }
+    sim::AuxDetHitCollection GetHits() const
+    {
+      return hitCollection.to_collection<sim::AuxDetHitCollection>();
+    }
+    AuxDetSDOptions const& GetOptions() const { return sdOptions; }
+
+    /// Hits are recorded only while the policy `current` points to, the one
+    /// of the generator of the tracked particle, asks for them (all if not set).
+    void SetGeneratorPolicy(GeneratorPolicy const* current) { generatorPolicy = current; }
+
+    /// Declares the channel the volume placed with copy number `copyNo` reads out.
+    void SetChannel(unsigned int copyNo, unsigned int auxDetID, unsigned int sensitiveID);
+
+    /// Groups the hits into one sim::AuxDetSimChannel per (AuxDet, sensitive
+    /// AuxDet), sorted by channel, with one IDE per track sorted by track ID.
+    std::vector<sim::AuxDetSimChannel> MakeSimChannels(sim::AuxDetHitCollection const& hits) const;
 
   private:
-    TempHitCollection temphitCollection;
-    sim::AuxDetHitCollection hitCollection;
+    static std::uint64_t key(unsigned int copyNo, unsigned int trackID)
+    {
+      return (std::uint64_t{copyNo} << 32) | trackID;
+    }
+
+    HitArena<sim::AuxDetHit> hitCollection;
+    /// (copy number, track ID) -> index of the hit the track contributes to
+    std::unordered_map<std::uint64_t, std::size_t> hitIndex;
+    AuxDetSDOptions sdOptions;
+    /// copy number -> (AuxDet ID, sensitive AuxDet ID)
+    std::unordered_map<unsigned int, std::pair<unsigned int, unsigned int>> channelMap;
+    GeneratorPolicy const* generatorPolicy{nullptr};
   };
 } // namespace larg4
 #if defined __clang__
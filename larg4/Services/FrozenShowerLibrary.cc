@@ -0,0 +1,135 @@
+//=============================================================================
+// FrozenShowerLibrary.cc
+//=============================================================================
+
+#include "larg4/Services/FrozenShowerLibrary.h"
+
+#include "cetlib_except/exception.h"
+
+#include <algorithm>
+#include <cstring>
+
+namespace {
+  constexpr char libraryMagic[8] = {'L', 'A', 'R', 'G', '4', 'F', 'S', 'L'};
+  constexpr std::uint32_t libraryVersion = 2;
+}
+
+larg4::FrozenShowerLibrary::FrozenShowerLibrary(std::string const& fileName) : file_{fileName}
+{
+  if (file_.size() < sizeof(Header)) {
+    throw cet::exception("FrozenShowerLibrary") << fileName << " is not a shower library.\n";
+  }
+  auto const& header = *reinterpret_cast<Header const*>(file_.data());
+  if (std::memcmp(header.magic, libraryMagic, sizeof libraryMagic) != 0 ||
+      header.version != libraryVersion) {
+    throw cet::exception("FrozenShowerLibrary")
+      << fileName << " is not a version " << libraryVersion << " shower library.\n";
+  }
+  std::size_t const expected = sizeof(Header) + header.nParticles * sizeof(Particle) +
+                               header.nBins * sizeof(Bin) + header.nShowers * sizeof(Shower) +
+                               header.nSpots * sizeof(Spot);
+  if (file_.size() != expected) {
+    throw cet::exception("FrozenShowerLibrary")
+      << fileName << " has " << file_.size() << " bytes, " << expected << " expected.\n";
+  }
+  char const* p = file_.data() + sizeof(Header);
+  nParticles_ = header.nParticles;
+  particles_ = reinterpret_cast<Particle const*>(p);
+  p += header.nParticles * sizeof(Particle);
+  bins_ = reinterpret_cast<Bin const*>(p);
+  p += header.nBins * sizeof(Bin);
+  showers_ = reinterpret_cast<Shower const*>(p);
+  p += header.nShowers * sizeof(Shower);
+  spots_ = reinterpret_cast<Spot const*>(p);
+
+  // -- the indices are checked once here, not for every shower picked
+  for (std::uint32_t i = 0; i < nParticles_; ++i) {
+    Particle const& particle = particles_[i];
+    if (particle.firstBin + particle.nBins > header.nBins) {
+      throw cet::exception("FrozenShowerLibrary") << fileName << " has invalid bin indices.\n";
+    }
+    for (std::uint32_t j = 0; j < particle.nBins; ++j) {
+      Bin const& bin = bins_[particle.firstBin + j];
+      if (bin.nShowers == 0 || bin.firstShower + bin.nShowers > header.nShowers) {
+        throw cet::exception("FrozenShowerLibrary")
+          << fileName << " has invalid shower indices.\n";
+      }
+    }
+  }
+  for (std::uint64_t i = 0; i < header.nShowers; ++i) {
+    if (showers_[i].firstSpot + showers_[i].nSpots > header.nSpots || !(showers_[i].energy > 0)) {
+      throw cet::exception("FrozenShowerLibrary") << fileName << " has invalid showers.\n";
+    }
+  }
+}
+
+larg4::FrozenShowerLibrary::Bin const* larg4::FrozenShowerLibrary::findBin(int pdg,
+                                                                         double energy) const
+{
+  for (std::uint32_t i = 0; i < nParticles_; ++i) {
+    if (particles_[i].pdg != pdg) continue;
+    Bin const* first = bins_ + particles_[i].firstBin;
+    Bin const* last = first + particles_[i].nBins;
+    auto const bin = std::upper_bound(
+      first, last, energy, [](double e, Bin const& b) { return e < b.maxEnergy; });
+    return (bin != last && energy >= bin->minEnergy) ? bin : nullptr;
+  }
+  return nullptr;
+}
+
+double larg4::FrozenShowerLibrary::maxEnergy(int pdg) const
+{
+  for (std::uint32_t i = 0; i < nParticles_; ++i) {
+    if (particles_[i].pdg == pdg && particles_[i].nBins > 0) {
+      return bins_[particles_[i].firstBin + particles_[i].nBins - 1].maxEnergy;
+    }
+  }
+  return 0.;
+}
+
+larg4::FrozenShowerLibrary::ShowerView larg4::FrozenShowerLibrary::pick(int pdg,
+                                                                      double energy,
+                                                                      double u) const
+{
+  Bin const& bin = *findBin(pdg, energy);
+  auto const i = std::min<std::uint32_t>(u * bin.nShowers, bin.nShowers - 1);
+  Shower const& shower = showers_[bin.firstShower + i];
+  Spot const* first = spots_ + shower.firstSpot;
+  return {first, first + shower.nSpots, shower.energy};
+}
+
+void larg4::FrozenShowerLibrary::write(std::string const& fileName, Content const& content)
+{
+  Header header{};
+  std::memcpy(header.magic, libraryMagic, sizeof libraryMagic);
+  header.version = libraryVersion;
+  std::vector<Particle> particles;
+  std::vector<Bin> bins;
+  std::vector<Shower> showers;
+  std::vector<Spot> spots;
+  for (auto const& [pdg, particleBins] : content) {
+    particles.push_back({pdg, static_cast<std::uint32_t>(particleBins.size()), bins.size()});
+    for (auto const& bin : particleBins) {
+      bins.push_back({bin.minEnergy,
+                      bin.maxEnergy,
+                      static_cast<std::uint32_t>(bin.showers.size()),
+                      0,
+                      showers.size()});
+      for (auto const& [energy, showerSpots] : bin.showers) {
+        showers.push_back({spots.size(), static_cast<std::uint32_t>(showerSpots.size()), energy});
+        spots.insert(spots.end(), showerSpots.begin(), showerSpots.end());
+      }
+    }
+  }
+  header.nParticles = particles.size();
+  header.nBins = bins.size();
+  header.nShowers = showers.size();
+  header.nSpots = spots.size();
+
+  writeFileAtomically(fileName,
+                      {{reinterpret_cast<char const*>(&header), sizeof header},
+                       bytesOf(particles),
+                       bytesOf(bins),
+                       bytesOf(showers),
+                       bytesOf(spots)});
+}
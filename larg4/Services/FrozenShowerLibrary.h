@@ -0,0 +1,108 @@
+//=============================================================================
+// FrozenShowerLibrary.h:
+// Library of pre-simulated low-energy electromagnetic showers, used by
+// FrozenShowerModel in place of tracking the shower particles.
+//
+// The showers are stored by particle type and by bins of the kinetic energy
+// of the primary, as lists of energy spots relative to the starting point
+// of the primary, which moves along +z.  The library file is produced by
+// larg4MakeShowerLibrary and memory-mapped by the jobs reading it; its
+// layout (native byte order, 8-byte aligned sections) is:
+//   Header, Particle[nParticles], Bin[nBins], Shower[nShowers], Spot[nSpots]
+// with the bins of a particle contiguous and sorted by energy, and the
+// indices of the first bin, shower and spot referring to the whole file.
+//=============================================================================
+
+#ifndef LARG4_SERVICES_FROZENSHOWERLIBRARY_H
+#define LARG4_SERVICES_FROZENSHOWERLIBRARY_H
+
+#include "larg4/Services/MappedFile.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <string>
+#include <vector>
+
+namespace larg4 {
+
+  class FrozenShowerLibrary {
+  public:
+    // -- file layout
+    struct Header {
+      char magic[8]; ///< "LARG4FSL"
+      std::uint32_t version;
+      std::uint32_t nParticles;
+      std::uint64_t nBins;
+      std::uint64_t nShowers;
+      std::uint64_t nSpots;
+    };
+    struct Particle {
+      std::int32_t pdg;
+      std::uint32_t nBins;
+      std::uint64_t firstBin;
+    };
+    struct Bin {
+      float minEnergy; ///< [MeV]
+      float maxEnergy; ///< [MeV]
+      std::uint32_t nShowers;
+      std::uint32_t padding;
+      std::uint64_t firstShower;
+    };
+    struct Shower {
+      std::uint64_t firstSpot;
+      std::uint32_t nSpots;
+      float energy; ///< kinetic energy of the primary [MeV]
+    };
+    // -- spots carry no time: like GFlash spots, they are recorded at the
+    //    time of the replaced particle (format version 2)
+    struct Spot {
+      float x, y, z; ///< [mm]
+      float e;       ///< [MeV]
+    };
+
+    /// A shower picked from the library.
+    struct ShowerView {
+      Spot const* begin;
+      Spot const* end;
+      float energy; ///< kinetic energy of the primary [MeV]
+    };
+
+    /// Content of a library to write: the showers of each particle type, by bin.
+    struct ShowerBin {
+      float minEnergy;
+      float maxEnergy;
+      std::vector<std::pair<float, std::vector<Spot>>> showers; ///< (energy, spots)
+    };
+    using Content = std::map<int, std::vector<ShowerBin>>;
+
+    /// Maps and validates `fileName`; throws cet::exception on a bad file.
+    explicit FrozenShowerLibrary(std::string const& fileName);
+
+    /// Whether a shower of `pdg` with kinetic energy `energy` [MeV] is available.
+    bool covers(int pdg, double energy) const { return findBin(pdg, energy) != nullptr; }
+
+    /// Highest energy [MeV] of the showers of `pdg`, 0 if there are none.
+    double maxEnergy(int pdg) const;
+
+    /// Picks one of the showers of the bin of (`pdg`, `energy`) with the
+    /// uniform random number `u` in [0, 1); the bin must be covered.
+    ShowerView pick(int pdg, double energy, double u) const;
+
+    /// Writes `content` to `fileName`.
+    static void write(std::string const& fileName, Content const& content);
+
+  private:
+    Bin const* findBin(int pdg, double energy) const;
+
+    MappedFile file_;
+    Particle const* particles_{nullptr};
+    std::uint32_t nParticles_{0};
+    Bin const* bins_{nullptr};
+    Shower const* showers_{nullptr};
+    Spot const* spots_{nullptr};
+  };
+
+} // namespace larg4
+
+#endif // LARG4_SERVICES_FROZENSHOWERLIBRARY_H
@@ -0,0 +1,59 @@
+//=============================================================================
+// FrozenShowerModel.cc
+//=============================================================================
+
+#include "larg4/Services/FrozenShowerModel.h"
+#include "larg4/Services/FrozenShowerLibrary.h"
+
+#include "Geant4/G4FastStep.hh"
+#include "Geant4/G4FastTrack.hh"
+#include "Geant4/G4PhysicalConstants.hh"
+#include "Geant4/G4RotationMatrix.hh"
+#include "Geant4/G4SystemOfUnits.hh"
+#include "Geant4/G4Track.hh"
+#include "Geant4/GFlashEnergySpot.hh"
+#include "Geant4/Randomize.hh"
+
+larg4::FrozenShowerModel::FrozenShowerModel(G4String const& name,
+                                            G4Region* region,
+                                            FrozenShowerLibrary const& library,
+                                            G4double maxEnergy)
+  : G4VFastSimulationModel(name, region), fLibrary(library), fMaxEnergy(maxEnergy)
+{}
+
+G4bool larg4::FrozenShowerModel::IsApplicable(G4ParticleDefinition const& particle)
+{
+  return fLibrary.maxEnergy(particle.GetPDGEncoding()) > 0.;
+}
+
+G4bool larg4::FrozenShowerModel::ModelTrigger(G4FastTrack const& track)
+{
+  G4Track const* particle = track.GetPrimaryTrack();
+  G4double const energy = particle->GetKineticEnergy();
+  return energy <= fMaxEnergy &&
+         fLibrary.covers(particle->GetParticleDefinition()->GetPDGEncoding(), energy / MeV);
+}
+
+void larg4::FrozenShowerModel::DoIt(G4FastTrack const& track, G4FastStep& step)
+{
+  G4Track const* particle = track.GetPrimaryTrack();
+  G4double const energy = particle->GetKineticEnergy();
+  auto const shower = fLibrary.pick(
+    particle->GetParticleDefinition()->GetPDGEncoding(), energy / MeV, G4UniformRand());
+
+  // -- library +z to the particle direction, with a random turn about it
+  G4RotationMatrix rotation;
+  rotation.rotateZ(twopi * G4UniformRand());
+  rotation.rotateUz(particle->GetMomentumDirection());
+  G4ThreeVector const& origin = particle->GetPosition();
+  G4double const scale = energy / (shower.energy * MeV);
+  for (auto spot = shower.begin; spot != shower.end; ++spot) {
+    G4ThreeVector const offset{spot->x * mm, spot->y * mm, spot->z * mm};
+    GFlashEnergySpot energySpot{spot->e * MeV * scale, origin + rotation * offset};
+    fHitMaker.make(&energySpot, &track);
+  }
+
+  step.KillPrimaryTrack();
+  step.ProposePrimaryTrackPathLength(0.);
+  step.ProposeTotalEnergyDeposited(energy);
+}
@@ -0,0 +1,54 @@
+//=============================================================================
+// FrozenShowerModel.h:
+// Library-based fast simulation of low-energy electrons, positrons and
+// photons, attached by LArG4DetectorService to the volumes carrying the
+// GDML auxiliary tag "FrozenShowers".
+//
+// A particle below the energy threshold for which the library has showers
+// is killed, and a shower picked at random from its energy bin is laid down
+// instead: the library shower is turned to the direction of the particle
+// with a random rotation about it, and its spot energies are scaled to the
+// particle energy.  The spots are recorded, like those of GFlash showers, by
+// the SimEnergyDepositSD of the volume they fall in; all of them are
+// attributed to the replaced particle, at its time.  The model needs the
+// fast simulation process for these particles in the physics list
+// (larg4Main: fastSimulationParticles: ["e-", "e+", "gamma"]).
+//=============================================================================
+
+#ifndef LARG4_SERVICES_FROZENSHOWERMODEL_H
+#define LARG4_SERVICES_FROZENSHOWERMODEL_H
+
+#include "Geant4/G4VFastSimulationModel.hh"
+#include "Geant4/GFlashHitMaker.hh"
+
+class G4FastStep;
+class G4FastTrack;
+class G4ParticleDefinition;
+class G4Region;
+
+namespace larg4 {
+
+  class FrozenShowerLibrary;
+
+  class FrozenShowerModel : public G4VFastSimulationModel {
+  public:
+    /// Particles with a kinetic energy up to `maxEnergy` are replaced by
+    /// showers of `library`, which must outlive the model.
+    FrozenShowerModel(G4String const& name,
+                      G4Region* region,
+                      FrozenShowerLibrary const& library,
+                      G4double maxEnergy);
+
+    G4bool IsApplicable(G4ParticleDefinition const& particle) override;
+    G4bool ModelTrigger(G4FastTrack const& track) override;
+    void DoIt(G4FastTrack const& track, G4FastStep& step) override;
+
+  private:
+    FrozenShowerLibrary const& fLibrary;
+    G4double fMaxEnergy;
+    GFlashHitMaker fHitMaker;
+  };
+
+} // namespace larg4
+
+#endif // LARG4_SERVICES_FROZENSHOWERMODEL_H
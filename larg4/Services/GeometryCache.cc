@@ -0,0 +1,868 @@
+//=============================================================================
+// GeometryCache.cc: binary cache of the Geant4 geometry built from GDML
+//
+// File layout:
+//   magic, format version, Geant4 version, content hash,
+//   payload size, payload, checksum of the payload.
+// The payload is read only once the header matches and the checksum is
+// verified, so a damaged cache never leaves a half-built geometry behind.
+//=============================================================================
+
+#include "larg4/Services/GeometryCache.h"
+#include "larg4/Services/Hash.h"
+#include "larg4/Services/MappedFile.h"
+
+#include "cetlib_except/exception.h"
+#include "messagefacility/MessageLogger/MessageLogger.h"
+
+#include "Geant4/G4BooleanSolid.hh"
+#include "Geant4/G4Box.hh"
+#include "Geant4/G4Colour.hh"
+#include "Geant4/G4Cons.hh"
+#include "Geant4/G4DisplacedSolid.hh"
+#include "Geant4/G4Element.hh"
+#include "Geant4/G4IntersectionSolid.hh"
+#include "Geant4/G4Isotope.hh"
+#include "Geant4/G4LogicalBorderSurface.hh"
+#include "Geant4/G4LogicalSkinSurface.hh"
+#include "Geant4/G4LogicalVolume.hh"
+#include "Geant4/G4LogicalVolumeStore.hh"
+#include "Geant4/G4Material.hh"
+#include "Geant4/G4MaterialPropertiesTable.hh"
+#include "Geant4/G4NistManager.hh"
+#include "Geant4/G4OpticalSurface.hh"
+#include "Geant4/G4PVPlacement.hh"
+#include "Geant4/G4PhysicalVolumeStore.hh"
+#include "Geant4/G4Polycone.hh"
+#include "Geant4/G4PolyconeHistorical.hh"
+#include "Geant4/G4RotationMatrix.hh"
+#include "Geant4/G4Sphere.hh"
+#include "Geant4/G4SubtractionSolid.hh"
+#include "Geant4/G4ThreeVector.hh"
+#include "Geant4/G4Transform3D.hh"
+#include "Geant4/G4Trd.hh"
+#include "Geant4/G4Tubs.hh"
+#include "Geant4/G4UnionSolid.hh"
+#include "Geant4/G4Version.hh"
+#include "Geant4/G4VisAttributes.hh"
+
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <iterator>
+#include <map>
+#include <regex>
+#include <set>
+#include <sstream>
+#include <type_traits>
+#include <vector>
+
+namespace {
+
+  constexpr char cacheMagic[8] = {'L', 'A', 'R', 'G', '4', 'G', 'E', 'O'};
+  constexpr std::uint32_t cacheFormatVersion = 1;
+
+  //---------------------------------------------------------------------------
+  std::string readFile(std::string const& path)
+  {
+    std::ifstream in{path, std::ios::binary};
+    if (!in) {
+      throw cet::exception("GeometryCache") << "Cannot read file: " << path << "\n";
+    }
+    return {std::istreambuf_iterator<char>{in}, std::istreambuf_iterator<char>{}};
+  }
+
+  std::string directoryOf(std::string const& path)
+  {
+    auto const pos = path.find_last_of('/');
+    return pos == std::string::npos ? std::string{"."} : path.substr(0, pos);
+  }
+
+  void readWithIncludes(std::string const& path,
+                        std::vector<std::pair<std::string, std::string>>& files,
+                        std::set<std::string>& seen)
+  {
+    if (!seen.insert(path).second) return;
+    files.emplace_back(path, readFile(path));
+    std::string const& content = files.back().second;
+
+    static std::regex const includes{R"(SYSTEM\s+"([^"]+)\"|<file\s+name\s*=\s*"([^"]+)\")"};
+    auto const dir = directoryOf(path);
+    std::vector<std::string> included;
+    for (std::sregex_iterator it{content.begin(), content.end(), includes}, end; it != end; ++it) {
+      std::string const name = (*it)[1].matched ? (*it)[1].str() : (*it)[2].str();
+      if (name.find("://") != std::string::npos) continue; // schema locations etc.
+      included.push_back(name.front() == '/' ? name : dir + '/' + name);
+    }
+    // -- `files` may reallocate from here on
+    for (auto const& name : included) {
+      readWithIncludes(name, files, seen);
+    }
+  }
+
+  //---------------------------------------------------------------------------
+  struct Unsupported {
+    std::string what;
+  };
+
+  class Writer {
+  public:
+    template <typename T>
+    void put(T value)
+    {
+      static_assert(std::is_arithmetic_v<T> || std::is_enum_v<T>);
+      buffer.append(reinterpret_cast<char const*>(&value), sizeof(T));
+    }
+    void put(std::string const& s)
+    {
+      put<std::uint64_t>(s.size());
+      buffer.append(s);
+    }
+    void put(char const* s) { put(std::string{s}); }
+    void put(G4String const& s) { put(static_cast<std::string const&>(s)); }
+    void put(std::vector<G4double> const& v)
+    {
+      put<std::uint64_t>(v.size());
+      for (auto const x : v)
+        put(x);
+    }
+    void put(G4ThreeVector const& v)
+    {
+      put(v.x());
+      put(v.y());
+      put(v.z());
+    }
+    void put(G4RotationMatrix const& r)
+    {
+      put(r.xx());
+      put(r.xy());
+      put(r.xz());
+      put(r.yx());
+      put(r.yy());
+      put(r.yz());
+      put(r.zx());
+      put(r.zy());
+      put(r.zz());
+    }
+
+    std::string buffer;
+  };
+
+  class Reader {
+  public:
+    Reader(char const* begin, char const* end) : p{begin}, e{end} {}
+
+    template <typename T>
+    T get()
+    {
+      static_assert(std::is_arithmetic_v<T> || std::is_enum_v<T>);
+      require(sizeof(T));
+      T value;
+      std::memcpy(&value, p, sizeof(T));
+      p += sizeof(T);
+      return value;
+    }
+    std::string getString()
+    {
+      auto const n = get<std::uint64_t>();
+      require(n);
+      std::string s{p, p + n};
+      p += n;
+      return s;
+    }
+    std::vector<G4double> getDoubles()
+    {
+      std::vector<G4double> v(get<std::uint64_t>());
+      for (auto& x : v)
+        x = get<G4double>();
+      return v;
+    }
+    G4ThreeVector getVector()
+    {
+      auto const x = get<G4double>();
+      auto const y = get<G4double>();
+      auto const z = get<G4double>();
+      return {x, y, z};
+    }
+    G4RotationMatrix getRotation()
+    {
+      CLHEP::HepRep3x3 m;
+      m.xx_ = get<G4double>();
+      m.xy_ = get<G4double>();
+      m.xz_ = get<G4double>();
+      m.yx_ = get<G4double>();
+      m.yy_ = get<G4double>();
+      m.yz_ = get<G4double>();
+      m.zx_ = get<G4double>();
+      m.zy_ = get<G4double>();
+      m.zz_ = get<G4double>();
+      return G4RotationMatrix{m};
+    }
+
+  private:
+    void require(std::size_t n) const
+    {
+      if (static_cast<std::size_t>(e - p) < n) {
+        throw cet::exception("GeometryCache") << "Truncated geometry cache payload.\n";
+      }
+    }
+    char const* p;
+    char const* e;
+  };
+
+  //---------------------------------------------------------------------------
+  // Material properties
+  void putProperties(Writer& w, G4MaterialPropertiesTable* mpt)
+  {
+    w.put<bool>(mpt != nullptr);
+    if (!mpt) return;
+    std::vector<std::pair<G4String, G4MaterialPropertyVector*>> vectors;
+    for (auto const& name : mpt->GetMaterialPropertyNames()) {
+      if (auto vec = mpt->GetProperty(name)) vectors.emplace_back(name, vec);
+    }
+    w.put<std::uint64_t>(vectors.size());
+    for (auto const& [name, vec] : vectors) {
+      w.put(name);
+      std::vector<G4double> energies, values;
+      for (std::size_t i = 0, n = vec->GetVectorLength(); i < n; ++i) {
+        energies.push_back(vec->Energy(i));
+        values.push_back((*vec)[i]);
+      }
+      w.put(energies);
+      w.put(values);
+    }
+    std::vector<std::pair<G4String, G4double>> constants;
+    for (auto const& name : mpt->GetMaterialConstPropertyNames()) {
+      if (mpt->ConstPropertyExists(name)) constants.emplace_back(name, mpt->GetConstProperty(name));
+    }
+    w.put<std::uint64_t>(constants.size());
+    for (auto const& [name, value] : constants) {
+      w.put(name);
+      w.put(value);
+    }
+  }
+
+  G4MaterialPropertiesTable* getProperties(Reader& r)
+  {
+    if (!r.get<bool>()) return nullptr;
+    auto mpt = new G4MaterialPropertiesTable;
+    for (auto n = r.get<std::uint64_t>(); n != 0; --n) {
+      auto const name = r.getString();
+      auto const energies = r.getDoubles();
+      auto const values = r.getDoubles();
+      mpt->AddProperty(name, energies, values, true);
+    }
+    for (auto n = r.get<std::uint64_t>(); n != 0; --n) {
+      auto const name = r.getString();
+      mpt->AddConstProperty(name, r.get<G4double>(), true);
+    }
+    return mpt;
+  }
+
+  //---------------------------------------------------------------------------
+  // Solids
+  enum class SolidType : std::uint8_t {
+    Box,
+    Tubs,
+    Cons,
+    Trd,
+    Sphere,
+    Polycone,
+    Union,
+    Subtraction,
+    Intersection
+  };
+
+  class SolidWriter {
+  public:
+    explicit SolidWriter(Writer& w) : w{w} {}
+
+    // Returns the index of the solid, writing it (and its constituents) first if needed.
+    std::uint32_t index(G4VSolid const* solid)
+    {
+      if (auto it = indices.find(solid); it != indices.end()) return it->second;
+      write(solid);
+      auto const i = static_cast<std::uint32_t>(indices.size());
+      indices.emplace(solid, i);
+      return i;
+    }
+
+  private:
+    void write(G4VSolid const* solid)
+    {
+      if (auto s = dynamic_cast<G4Box const*>(solid)) {
+        header(SolidType::Box, solid);
+        w.put(s->GetXHalfLength());
+        w.put(s->GetYHalfLength());
+        w.put(s->GetZHalfLength());
+      }
+      else if (auto s = dynamic_cast<G4Tubs const*>(solid)) {
+        header(SolidType::Tubs, solid);
+        w.put(s->GetInnerRadius());
+        w.put(s->GetOuterRadius());
+        w.put(s->GetZHalfLength());
+        w.put(s->GetStartPhiAngle());
+        w.put(s->GetDeltaPhiAngle());
+      }
+      else if (auto s = dynamic_cast<G4Cons const*>(solid)) {
+        header(SolidType::Cons, solid);
+        w.put(s->GetInnerRadiusMinusZ());
+        w.put(s->GetOuterRadiusMinusZ());
+        w.put(s->GetInnerRadiusPlusZ());
+        w.put(s->GetOuterRadiusPlusZ());
+        w.put(s->GetZHalfLength());
+        w.put(s->GetStartPhiAngle());
+        w.put(s->GetDeltaPhiAngle());
+      }
+      else if (auto s = dynamic_cast<G4Trd const*>(solid)) {
+        header(SolidType::Trd, solid);
+        w.put(s->GetXHalfLength1());
+        w.put(s->GetXHalfLength2());
+        w.put(s->GetYHalfLength1());
+        w.put(s->GetYHalfLength2());
+        w.put(s->GetZHalfLength());
+      }
+      else if (auto s = dynamic_cast<G4Sphere const*>(solid)) {
+        header(SolidType::Sphere, solid);
+        w.put(s->GetInnerRadius());
+        w.put(s->GetOuterRadius());
+        w.put(s->GetStartPhiAngle());
+        w.put(s->GetDeltaPhiAngle());
+        w.put(s->GetStartThetaAngle());
+        w.put(s->GetDeltaThetaAngle());
+      }
+      else if (auto s = dynamic_cast<G4Polycone const*>(solid)) {
+        G4PolyconeHistorical const* h = s->GetOriginalParameters();
+        header(SolidType::Polycone, solid);
+        w.put(h->Start_angle);
+        w.put(h->Opening_angle);
+        std::vector<G4double> z(h->Z_values, h->Z_values + h->Num_z_planes);
+        std::vector<G4double> rmin(h->Rmin, h->Rmin + h->Num_z_planes);
+        std::vector<G4double> rmax(h->Rmax, h->Rmax + h->Num_z_planes);
+        w.put(z);
+        w.put(rmin);
+        w.put(rmax);
+      }
+      else if (auto s = dynamic_cast<G4BooleanSolid const*>(solid)) {
+        SolidType type = SolidType::Union;
+        if (dynamic_cast<G4SubtractionSolid const*>(solid))
+          type = SolidType::Subtraction;
+        else if (dynamic_cast<G4IntersectionSolid const*>(solid))
+          type = SolidType::Intersection;
+        else if (!dynamic_cast<G4UnionSolid const*>(solid))
+          throw Unsupported{"boolean solid " + solid->GetName()};
+
+        G4VSolid const* first = s->GetConstituentSolid(0);
+        G4VSolid const* second = s->GetConstituentSolid(1);
+        if (dynamic_cast<G4DisplacedSolid const*>(first)) {
+          throw Unsupported{"displaced first constituent of " + solid->GetName()};
+        }
+        G4RotationMatrix rotation;
+        G4ThreeVector translation;
+        if (auto d = dynamic_cast<G4DisplacedSolid const*>(second)) {
+          rotation = d->GetObjectRotation();
+          translation = d->GetObjectTranslation();
+          second = d->GetConstituentMovedSolid();
+        }
+        auto const iFirst = index(first);
+        auto const iSecond = index(second);
+        header(type, solid);
+        w.put(iFirst);
+        w.put(iSecond);
+        w.put(rotation);
+        w.put(translation);
+      }
+      else {
+        throw Unsupported{"solid " + solid->GetName() + " of type " + solid->GetEntityType()};
+      }
+    }
+
+    void header(SolidType type, G4VSolid const* solid)
+    {
+      w.put(type);
+      w.put(solid->GetName());
+    }
+
+    Writer& w;
+    std::map<G4VSolid const*, std::uint32_t> indices;
+  };
+
+  G4VSolid* readSolid(Reader& r, std::vector<G4VSolid*> const& solids)
+  {
+    auto const type = r.get<SolidType>();
+    auto const name = r.getString();
+    auto d = [&r] { return r.get<G4double>(); };
+    switch (type) {
+    case SolidType::Box: {
+      auto const x = d(), y = d(), z = d();
+      return new G4Box(name, x, y, z);
+    }
+    case SolidType::Tubs: {
+      auto const rmin = d(), rmax = d(), dz = d(), sphi = d(), dphi = d();
+      return new G4Tubs(name, rmin, rmax, dz, sphi, dphi);
+    }
+    case SolidType::Cons: {
+      auto const rmin1 = d(), rmax1 = d(), rmin2 = d(), rmax2 = d(), dz = d(), sphi = d(),
+                 dphi = d();
+      return new G4Cons(name, rmin1, rmax1, rmin2, rmax2, dz, sphi, dphi);
+    }
+    case SolidType::Trd: {
+      auto const dx1 = d(), dx2 = d(), dy1 = d(), dy2 = d(), dz = d();
+      return new G4Trd(name, dx1, dx2, dy1, dy2, dz);
+    }
+    case SolidType::Sphere: {
+      auto const rmin = d(), rmax = d(), sphi = d(), dphi = d(), stheta = d(), dtheta = d();
+      return new G4Sphere(name, rmin, rmax, sphi, dphi, stheta, dtheta);
+    }
+    case SolidType::Polycone: {
+      auto const sphi = d(), dphi = d();
+      auto const z = r.getDoubles();
+      auto const rmin = r.getDoubles();
+      auto const rmax = r.getDoubles();
+      return new G4Polycone(
+        name, sphi, dphi, static_cast<G4int>(z.size()), z.data(), rmin.data(), rmax.data());
+    }
+    case SolidType::Union:
+    case SolidType::Subtraction:
+    case SolidType::Intersection: {
+      G4VSolid* first = solids.at(r.get<std::uint32_t>());
+      G4VSolid* second = solids.at(r.get<std::uint32_t>());
+      auto const rotation = r.getRotation();
+      auto const translation = r.getVector();
+      G4Transform3D const transform{rotation, translation};
+      if (type == SolidType::Union) return new G4UnionSolid(name, first, second, transform);
+      if (type == SolidType::Subtraction)
+        return new G4SubtractionSolid(name, first, second, transform);
+      return new G4IntersectionSolid(name, first, second, transform);
+    }
+    }
+    throw cet::exception("GeometryCache") << "Unknown solid type in geometry cache.\n";
+  }
+
+  //---------------------------------------------------------------------------
+  // Auxiliary information
+  void putAuxList(Writer& w, G4GDMLAuxListType const& list)
+  {
+    w.put<std::uint64_t>(list.size());
+    for (auto const& aux : list) {
+      w.put(aux.type);
+      w.put(aux.value);
+      w.put(aux.unit);
+      w.put<bool>(aux.auxList != nullptr);
+      if (aux.auxList) putAuxList(w, *aux.auxList);
+    }
+  }
+
+  void getAuxList(Reader& r, G4GDMLAuxListType& list, std::deque<G4GDMLAuxListType>& storage)
+  {
+    for (auto n = r.get<std::uint64_t>(); n != 0; --n) {
+      G4GDMLAuxStructType aux;
+      aux.type = r.getString();
+      aux.value = r.getString();
+      aux.unit = r.getString();
+      aux.auxList = nullptr;
+      if (r.get<bool>()) {
+        aux.auxList = &storage.emplace_back();
+        getAuxList(r, *aux.auxList, storage);
+      }
+      list.push_back(aux);
+    }
+  }
+
+  //---------------------------------------------------------------------------
+  void putOpticalSurface(Writer& w, G4SurfaceProperty const* property)
+  {
+    auto surface = dynamic_cast<G4OpticalSurface const*>(property);
+    if (!surface) throw Unsupported{"non-optical surface property"};
+    w.put(surface->GetName());
+    w.put(surface->GetModel());
+    w.put(surface->GetFinish());
+    w.put(surface->GetType());
+    w.put(surface->GetPolish());
+    w.put(surface->GetSigmaAlpha());
+    putProperties(w, surface->GetMaterialPropertiesTable());
+  }
+
+  G4OpticalSurface* getOpticalSurface(Reader& r)
+  {
+    auto const name = r.getString();
+    auto const model = r.get<G4OpticalSurfaceModel>();
+    auto const finish = r.get<G4OpticalSurfaceFinish>();
+    auto const type = r.get<G4SurfaceType>();
+    auto const polish = r.get<G4double>();
+    auto const sigmaAlpha = r.get<G4double>();
+    auto surface = new G4OpticalSurface(name, model, finish, type);
+    surface->SetPolish(polish);
+    surface->SetSigmaAlpha(sigmaAlpha);
+    if (auto mpt = getProperties(r)) surface->SetMaterialPropertiesTable(mpt);
+    return surface;
+  }
+
+  template <typename T>
+  std::uint32_t indexOf(std::map<T const*, std::uint32_t> const& indices, T const* p)
+  {
+    auto it = indices.find(p);
+    if (it == indices.end()) throw Unsupported{"reference to an object outside the stores"};
+    return it->second;
+  }
+
+} // namespace
+
+//-----------------------------------------------------------------------------
+larg4::GeometryCache::GeometryCache(std::string const& directory, std::string const& gdmlFile)
+  : hash_{contentHash(gdmlFile)}
+{
+  auto const slash = gdmlFile.find_last_of('/');
+  std::string const base = slash == std::string::npos ? gdmlFile : gdmlFile.substr(slash + 1);
+  std::ostringstream name;
+  name << directory << '/' << base << '.' << std::hex << std::setw(16) << std::setfill('0')
+       << hash_ << ".g4geo";
+  fileName_ = name.str();
+}
+
+std::vector<std::pair<std::string, std::string>> larg4::readGDMLFiles(std::string const& gdmlFile)
+{
+  std::vector<std::pair<std::string, std::string>> files;
+  std::set<std::string> seen;
+  readWithIncludes(gdmlFile, files, seen);
+  return files;
+}
+
+std::uint64_t larg4::GeometryCache::contentHash(std::string const& gdmlFile)
+{
+  std::uint64_t h = fnv1aBasis;
+  for (auto const& [path, content] : readGDMLFiles(gdmlFile)) {
+    h = fnv1a(content.data(), content.size(), h);
+  }
+  return h;
+}
+
+//-----------------------------------------------------------------------------
+bool larg4::GeometryCache::store(G4VPhysicalVolume const* world,
+                                 G4GDMLAuxMapType const& auxmap) const
+{
+  Writer w;
+  try {
+    // -- isotopes and elements
+    std::map<G4Element const*, std::uint32_t> elementIndex;
+    auto const& elements = *G4Element::GetElementTable();
+    w.put<std::uint64_t>(elements.size());
+    for (G4Element const* element : elements) {
+      elementIndex.emplace(element, elementIndex.size());
+      w.put(element->GetName());
+      w.put(element->GetSymbol());
+      w.put(element->GetZ());
+      w.put(element->GetA());
+      bool const natural = element->GetNaturalAbundanceFlag();
+      w.put<bool>(natural);
+      if (natural) continue;
+      auto const nIsotopes = element->GetNumberOfIsotopes();
+      w.put<std::uint64_t>(nIsotopes);
+      for (std::size_t i = 0; i < nIsotopes; ++i) {
+        G4Isotope const* isotope = (*element->GetIsotopeVector())[i];
+        w.put(isotope->GetName());
+        w.put(isotope->GetZ());
+        w.put(isotope->GetN());
+        w.put(isotope->GetA());
+        w.put(isotope->Getm());
+        w.put(element->GetRelativeAbundanceVector()[i]);
+      }
+    }
+
+    // -- materials
+    std::map<G4Material const*, std::uint32_t> materialIndex;
+    auto const& materials = *G4Material::GetMaterialTable();
+    w.put<std::uint64_t>(materials.size());
+    for (G4Material const* material : materials) {
+      materialIndex.emplace(material, materialIndex.size());
+      w.put(material->GetName());
+      w.put(material->GetDensity());
+      w.put(material->GetState());
+      w.put(material->GetTemperature());
+      w.put(material->GetPressure());
+      w.put(material->GetIonisation()->GetMeanExcitationEnergy());
+      auto const nElements = material->GetNumberOfElements();
+      w.put<std::uint64_t>(nElements);
+      for (std::size_t i = 0; i < nElements; ++i) {
+        w.put(indexOf(elementIndex, material->GetElement(i)));
+        w.put(material->GetFractionVector()[i]);
+      }
+      putProperties(w, material->GetMaterialPropertiesTable());
+    }
+
+    // -- solids and logical volumes, in store order
+    SolidWriter solids{w};
+    std::map<G4LogicalVolume const*, std::uint32_t> volumeIndex;
+    auto const& volumes = *G4LogicalVolumeStore::GetInstance();
+    std::vector<std::uint32_t> solidOfVolume; // all solids are written before the volumes
+    for (G4LogicalVolume const* lv : volumes) {
+      solidOfVolume.push_back(solids.index(lv->GetSolid()));
+    }
+    w.put<std::uint8_t>(0xff); // end of solids
+    w.put<std::uint64_t>(volumes.size());
+    for (G4LogicalVolume const* lv : volumes) {
+      w.put(lv->GetName());
+      w.put(solidOfVolume[volumeIndex.size()]);
+      volumeIndex.emplace(lv, volumeIndex.size());
+      w.put(indexOf(materialIndex, lv->GetMaterial()));
+      G4VisAttributes const* vis = lv->GetVisAttributes();
+      w.put<bool>(vis != nullptr);
+      if (vis) {
+        G4Colour const& colour = vis->GetColour();
+        w.put(colour.GetRed());
+        w.put(colour.GetGreen());
+        w.put(colour.GetBlue());
+        w.put(colour.GetAlpha());
+        w.put<bool>(vis->IsVisible());
+      }
+    }
+
+    // -- placements, in store order (the world is the last one)
+    std::map<G4VPhysicalVolume const*, std::uint32_t> placementIndex;
+    auto const& placements = *G4PhysicalVolumeStore::GetInstance();
+    if (placements.empty() || placements.back() != world) {
+      throw Unsupported{"world volume is not the last placement"};
+    }
+    w.put<std::uint64_t>(placements.size());
+    for (G4VPhysicalVolume const* pv : placements) {
+      if (!dynamic_cast<G4PVPlacement const*>(pv)) {
+        throw Unsupported{"replicated or parameterised volume " + pv->GetName()};
+      }
+      placementIndex.emplace(pv, placementIndex.size());
+      w.put(pv->GetName());
+      w.put(indexOf(volumeIndex, pv->GetLogicalVolume()));
+      G4LogicalVolume const* mother = pv->GetMotherLogical();
+      w.put<bool>(mother != nullptr);
+      if (mother) w.put(indexOf(volumeIndex, mother));
+      w.put(pv->GetCopyNo());
+      w.put(pv->GetObjectRotationValue());
+      w.put(pv->GetObjectTranslation());
+    }
+
+    // -- optical surfaces
+    auto const* borders = G4LogicalBorderSurface::GetSurfaceTable();
+    w.put<std::uint64_t>(borders ? borders->size() : 0);
+    if (borders) {
+      for (auto const& [pvs, surface] : *borders) {
+        w.put(surface->GetName());
+        w.put(indexOf(placementIndex, surface->GetVolume1()));
+        w.put(indexOf(placementIndex, surface->GetVolume2()));
+        putOpticalSurface(w, surface->GetSurfaceProperty());
+      }
+    }
+    auto const* skins = G4LogicalSkinSurface::GetSurfaceTable();
+    w.put<std::uint64_t>(skins ? skins->size() : 0);
+    if (skins) {
+      for (auto const& [volume, surface] : *skins) {
+        w.put(surface->GetName());
+        w.put(indexOf(volumeIndex, surface->GetLogicalVolume()));
+        putOpticalSurface(w, surface->GetSurfaceProperty());
+      }
+    }
+
+    // -- auxiliary information
+    w.put<std::uint64_t>(auxmap.size());
+    for (auto const& [volume, auxes] : auxmap) {
+      w.put(indexOf(volumeIndex, static_cast<G4LogicalVolume const*>(volume)));
+      putAuxList(w, auxes);
+    }
+  }
+  catch (Unsupported const& u) {
+    mf::LogInfo("GeometryCache") << "Geometry not cached: unsupported " << u.what << ".";
+    return false;
+  }
+
+  Writer header;
+  header.buffer.append(cacheMagic, sizeof(cacheMagic));
+  header.put(cacheFormatVersion);
+  header.put<std::int32_t>(G4VERSION_NUMBER);
+  header.put(hash_);
+  header.put<std::uint64_t>(w.buffer.size());
+  auto const checksum = fnv1a(w.buffer.data(), w.buffer.size());
+  try {
+    // -- concurrent jobs never see a partial cache
+    writeFileAtomically(
+      fileName_,
+      {header.buffer, w.buffer, {reinterpret_cast<char const*>(&checksum), sizeof(checksum)}});
+  }
+  catch (cet::exception const& e) {
+    mf::LogWarning("GeometryCache") << "Cannot write geometry cache: " << e.what();
+    return false;
+  }
+  mf::LogInfo("GeometryCache") << "Wrote geometry cache " << fileName_;
+  return true;
+}
+
+//-----------------------------------------------------------------------------
+G4VPhysicalVolume* larg4::GeometryCache::load(G4GDMLAuxMapType& auxmap)
+{
+  std::ifstream in{fileName_, std::ios::binary};
+  if (!in) {
+    mf::LogInfo("GeometryCache") << "No geometry cache " << fileName_;
+    return nullptr;
+  }
+  std::string const content{std::istreambuf_iterator<char>{in}, std::istreambuf_iterator<char>{}};
+
+  // -- validate the header and the checksum before building anything
+  constexpr std::size_t headerSize = sizeof(cacheMagic) + sizeof(std::uint32_t) +
+                                     sizeof(std::int32_t) + 2 * sizeof(std::uint64_t);
+  Reader header{content.data(), content.data() + content.size()};
+  auto stale = [this](char const* why) {
+    mf::LogInfo("GeometryCache") << "Ignoring geometry cache " << fileName_ << ": " << why;
+    return nullptr;
+  };
+  if (content.size() < headerSize + sizeof(std::uint64_t) ||
+      std::memcmp(content.data(), cacheMagic, sizeof(cacheMagic)) != 0) {
+    return stale("not a geometry cache");
+  }
+  Reader r{content.data() + sizeof(cacheMagic), content.data() + content.size()};
+  if (r.get<std::uint32_t>() != cacheFormatVersion) return stale("different format version");
+  if (r.get<std::int32_t>() != G4VERSION_NUMBER) return stale("different Geant4 version");
+  if (r.get<std::uint64_t>() != hash_) return stale("different GDML content");
+  auto const payloadSize = r.get<std::uint64_t>();
+  if (content.size() != headerSize + payloadSize + sizeof(std::uint64_t)) {
+    return stale("truncated");
+  }
+  char const* payload = content.data() + headerSize;
+  std::uint64_t checksum;
+  std::memcpy(&checksum, payload + payloadSize, sizeof(checksum));
+  if (checksum != fnv1a(payload, payloadSize)) return stale("checksum mismatch");
+
+  r = Reader{payload, payload + payloadSize};
+
+  // -- isotopes and elements
+  std::vector<G4Element*> elements;
+  for (auto n = r.get<std::uint64_t>(); n != 0; --n) {
+    auto const name = r.getString();
+    auto const symbol = r.getString();
+    auto const z = r.get<G4double>();
+    auto const a = r.get<G4double>();
+    G4Element* element = G4Element::GetElement(name, false);
+    if (r.get<bool>()) { // natural abundances
+      if (!element) element = new G4Element(name, symbol, z, a);
+      elements.push_back(element);
+      continue;
+    }
+    auto const nIsotopes = r.get<std::uint64_t>();
+    if (!element) element = new G4Element(name, symbol, static_cast<G4int>(nIsotopes));
+    bool const fill = element->GetNumberOfIsotopes() == 0;
+    for (auto i = nIsotopes; i != 0; --i) {
+      auto const isoName = r.getString();
+      auto const isoZ = r.get<G4int>();
+      auto const isoN = r.get<G4int>();
+      auto const isoA = r.get<G4double>();
+      auto const isoM = r.get<G4int>();
+      auto const abundance = r.get<G4double>();
+      if (!fill) continue;
+      G4Isotope* isotope = G4Isotope::GetIsotope(isoName, false);
+      if (!isotope) isotope = new G4Isotope(isoName, isoZ, isoN, isoA, isoM);
+      element->AddIsotope(isotope, abundance);
+    }
+    elements.push_back(element);
+  }
+
+  // -- materials
+  std::vector<G4Material*> materials;
+  for (auto n = r.get<std::uint64_t>(); n != 0; --n) {
+    auto const name = r.getString();
+    auto const density = r.get<G4double>();
+    auto const state = r.get<G4State>();
+    auto const temperature = r.get<G4double>();
+    auto const pressure = r.get<G4double>();
+    auto const meanExcitation = r.get<G4double>();
+    auto const nElements = r.get<std::uint64_t>();
+    std::vector<std::pair<G4Element*, G4double>> components;
+    for (auto i = nElements; i != 0; --i) {
+      G4Element* element = elements.at(r.get<std::uint32_t>());
+      components.emplace_back(element, r.get<G4double>());
+    }
+    auto mpt = getProperties(r);
+
+    G4Material* material = G4Material::GetMaterial(name, false);
+    if (!material && name.rfind("G4_", 0) == 0) {
+      material = G4NistManager::Instance()->FindOrBuildMaterial(name);
+    }
+    if (!material) {
+      material = new G4Material(
+        name, density, static_cast<G4int>(nElements), state, temperature, pressure);
+      for (auto const& [element, fraction] : components) {
+        material->AddElement(element, fraction);
+      }
+      material->GetIonisation()->SetMeanExcitationEnergy(meanExcitation);
+      if (mpt) material->SetMaterialPropertiesTable(mpt);
+    }
+    else {
+      delete mpt;
+    }
+    materials.push_back(material);
+  }
+
+  // -- solids
+  std::vector<G4VSolid*> solids;
+  for (;;) {
+    // peek at the solid type; 0xff ends the list
+    Reader peek = r;
+    if (peek.get<std::uint8_t>() == 0xff) {
+      r.get<std::uint8_t>();
+      break;
+    }
+    solids.push_back(readSolid(r, solids));
+  }
+
+  // -- logical volumes
+  std::vector<G4LogicalVolume*> volumes;
+  for (auto n = r.get<std::uint64_t>(); n != 0; --n) {
+    auto const name = r.getString();
+    G4VSolid* solid = solids.at(r.get<std::uint32_t>());
+    G4Material* material = materials.at(r.get<std::uint32_t>());
+    auto lv = new G4LogicalVolume(solid, material, name);
+    if (r.get<bool>()) {
+      auto const red = r.get<G4double>();
+      auto const green = r.get<G4double>();
+      auto const blue = r.get<G4double>();
+      auto const alpha = r.get<G4double>();
+      auto vis = new G4VisAttributes(G4Colour(red, green, blue, alpha));
+      vis->SetVisibility(r.get<bool>());
+      lv->SetVisAttributes(vis);
+    }
+    volumes.push_back(lv);
+  }
+
+  // -- placements
+  std::vector<G4VPhysicalVolume*> placements;
+  for (auto n = r.get<std::uint64_t>(); n != 0; --n) {
+    auto const name = r.getString();
+    G4LogicalVolume* lv = volumes.at(r.get<std::uint32_t>());
+    G4LogicalVolume* mother = r.get<bool>() ? volumes.at(r.get<std::uint32_t>()) : nullptr;
+    auto const copyNo = r.get<G4int>();
+    auto const rotation = r.getRotation();
+    auto const translation = r.getVector();
+    placements.push_back(new G4PVPlacement(
+      G4Transform3D{rotation, translation}, lv, name, mother, false, copyNo, false));
+  }
+
+  // -- optical surfaces
+  for (auto n = r.get<std::uint64_t>(); n != 0; --n) {
+    auto const name = r.getString();
+    G4VPhysicalVolume* pv1 = placements.at(r.get<std::uint32_t>());
+    G4VPhysicalVolume* pv2 = placements.at(r.get<std::uint32_t>());
+    new G4LogicalBorderSurface(name, pv1, pv2, getOpticalSurface(r));
+  }
+  for (auto n = r.get<std::uint64_t>(); n != 0; --n) {
+    auto const name = r.getString();
+    G4LogicalVolume* lv = volumes.at(r.get<std::uint32_t>());
+    new G4LogicalSkinSurface(name, lv, getOpticalSurface(r));
+  }
+
+  // -- auxiliary information
+  auxmap.clear();
+  for (auto n = r.get<std::uint64_t>(); n != 0; --n) {
+    G4LogicalVolume* lv = volumes.at(r.get<std::uint32_t>());
+    getAuxList(r, auxmap[lv], auxLists_);
+  }
+
+  mf::LogInfo("GeometryCache") << "Loaded geometry from cache " << fileName_ << ": "
+                               << volumes.size() << " logical volumes, " << placements.size()
+                               << " placements.";
+  return placements.empty() ? nullptr : placements.back();
+}
@@ -0,0 +1,69 @@
+//=============================================================================
+// GeometryCache.h:
+// On-disk binary cache of the Geant4 geometry built from a GDML file, used by
+// LArG4DetectorService to skip G4GDMLParser on job start.
+//
+// The cache holds the isotopes, elements, materials (with their property
+// tables), solids, logical volumes (with their visualization attributes),
+// placements, optical border and skin surfaces and the GDML auxiliary map.
+// It is keyed by a content hash of the GDML file and of the files it
+// includes, and by the cache format and Geant4 versions; a missing, stale or
+// damaged cache is reported by load() returning nullptr, and the caller is
+// expected to parse the GDML file and store() the result.
+//
+// Only constructs LArSoft geometries use are supported (box, tube, cone,
+// trapezoid, sphere, polycone and boolean solids, simple placements); a
+// geometry using anything else is simply not cached.
+//=============================================================================
+
+#ifndef LARG4_SERVICES_GEOMETRYCACHE_H
+#define LARG4_SERVICES_GEOMETRYCACHE_H
+
+#include "Geant4/G4GDMLAuxStructType.hh"
+#include "Geant4/G4GDMLReadStructure.hh"
+
+#include <cstdint>
+#include <deque>
+#include <string>
+#include <utility>
+#include <vector>
+
+class G4VPhysicalVolume;
+
+namespace larg4 {
+
+  /// Path and content of `gdmlFile` and, recursively, of the files it pulls
+  /// in through external entities (<!ENTITY x SYSTEM "file">) and modular
+  /// GDML (<file name="...">), each file once, in the order they are met.
+  std::vector<std::pair<std::string, std::string>> readGDMLFiles(std::string const& gdmlFile);
+
+  class GeometryCache {
+  public:
+    /// Cache for `gdmlFile` (full path) in `directory`.
+    GeometryCache(std::string const& directory, std::string const& gdmlFile);
+
+    /// Content hash of the GDML file and of all the files it includes.
+    static std::uint64_t contentHash(std::string const& gdmlFile);
+
+    std::uint64_t hash() const { return hash_; }
+    std::string const& fileName() const { return fileName_; }
+
+    /// Rebuilds the geometry from the cache and fills `auxmap`; returns the
+    /// world volume, or nullptr (without building anything) if there is no
+    /// valid cache.
+    G4VPhysicalVolume* load(G4GDMLAuxMapType& auxmap);
+
+    /// Writes the geometry currently in the Geant4 stores; returns false if
+    /// the geometry uses constructs the cache does not support or the file
+    /// cannot be written.
+    bool store(G4VPhysicalVolume const* world, G4GDMLAuxMapType const& auxmap) const;
+
+  private:
+    std::uint64_t hash_;
+    std::string fileName_;
+    std::deque<G4GDMLAuxListType> auxLists_; ///< storage of nested auxiliary lists
+  };
+
+} // namespace larg4
+
+#endif // LARG4_SERVICES_GEOMETRYCACHE_H
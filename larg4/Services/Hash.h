@@ -0,0 +1,47 @@
+//=============================================================================
+// Hash.h:
+// Hash functions for keys that are written to files or shared between jobs
+// (cache keys, per-event seeds, event partitions), where the result must
+// not depend on the platform or on the standard library, unlike std::hash.
+//=============================================================================
+
+#ifndef LARG4_SERVICES_HASH_H
+#define LARG4_SERVICES_HASH_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+namespace larg4 {
+
+  inline constexpr std::uint64_t fnv1aBasis = 0xcbf29ce484222325ULL;
+
+  /// FNV-1a, 64 bit, of `n` bytes at `data`, continuing from `h`.
+  inline std::uint64_t fnv1a(void const* data, std::size_t n, std::uint64_t h = fnv1aBasis)
+  {
+    auto const bytes = static_cast<unsigned char const*>(data);
+    for (std::size_t i = 0; i < n; ++i) {
+      h ^= bytes[i];
+      h *= 0x100000001b3ULL;
+    }
+    return h;
+  }
+
+  inline std::uint64_t fnv1a(std::string_view s, std::uint64_t h = fnv1aBasis)
+  {
+    return fnv1a(s.data(), s.size(), h);
+  }
+
+  /// SplitMix64 finalizer: a bijection spreading nearby inputs over the
+  /// whole 64-bit range.
+  constexpr std::uint64_t splitMix64(std::uint64_t x)
+  {
+    x += 0x9e3779b97f4a7c15ULL;
+    x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    x = (x ^ (x >> 27)) * 0x94d049bb133111ebULL;
+    return x ^ (x >> 31);
+  }
+
+} // namespace larg4
+
+#endif // LARG4_SERVICES_HASH_H
@@ -0,0 +1,200 @@
+//=============================================================================
+// HitArena.h: chunked, non-relocating hit storage for larg4 sensitive detectors
+//
+// Each sensitive detector owns one arena (and each sensitive detector lives on
+// exactly one Geant4 thread), so no synchronization is needed.  Hits are
+// appended into fixed-size chunks: growth allocates a new chunk and never
+// copies the hits that are already stored.  reset() is called once per event
+// from G4VSensitiveDetector::Initialize; it destroys the hits but keeps as
+// many chunks allocated as the largest event seen in the last
+// `historyLength` events needed, so a typical event does not allocate at all
+// and memory taken by an exceptional event is given back a few events later.
+//=============================================================================
+
+#ifndef LARG4_SERVICES_HITARENA_H
+#define LARG4_SERVICES_HITARENA_H
+
+#include <algorithm>
+#include <cstddef>
+#include <iterator>
+#include <type_traits>
+#include <vector>
+
+namespace larg4 {
+
+  template <typename T>
+  class HitArena {
+    template <bool Const>
+    class basic_iterator;
+
+  public:
+    using value_type = T;
+    using size_type = std::size_t;
+    using iterator = basic_iterator<false>;
+    using const_iterator = basic_iterator<true>;
+
+    /// `chunkSize` is rounded up to a power of two; `historyLength` is the
+    /// number of past events used to pre-size the arena.
+    explicit HitArena(size_type chunkSize = 4096, size_type historyLength = 8)
+      : fHistory(std::max<size_type>(historyLength, 1), 0)
+    {
+      while ((size_type{1} << fShift) < std::max<size_type>(chunkSize, 1))
+        ++fShift;
+      fMask = (size_type{1} << fShift) - 1;
+    }
+
+    template <typename... Args>
+    T& emplace_back(Args&&... args)
+    {
+      auto const chunk = fSize >> fShift;
+      if (chunk == fChunks.size()) addChunk();
+      ++fSize;
+      return fChunks[chunk].emplace_back(std::forward<Args>(args)...);
+    }
+
+    void push_back(T const& hit) { emplace_back(hit); }
+    void push_back(T&& hit) { emplace_back(std::move(hit)); }
+
+    /// Drops all hits, records the size of the finished event and adjusts the
+    /// number of allocated chunks to the recent history.
+    void reset()
+    {
+      fHistory[fHistoryPos] = fSize;
+      fHistoryPos = (fHistoryPos + 1) % fHistory.size();
+      for (size_type i = 0, n = usedChunks(); i != n; ++i)
+        fChunks[i].clear();
+      fSize = 0;
+
+      auto const expected = *std::max_element(fHistory.begin(), fHistory.end());
+      auto const nChunks = std::max<size_type>((expected + fMask) >> fShift, 1);
+      if (fChunks.size() > nChunks) fChunks.resize(nChunks);
+      while (fChunks.size() < nChunks)
+        addChunk();
+    }
+
+    size_type size() const { return fSize; }
+    bool empty() const { return fSize == 0; }
+    size_type chunkSize() const { return fMask + 1; }
+    /// Number of hits the allocated chunks hold without allocating.
+    size_type capacity() const { return fChunks.size() * chunkSize(); }
+
+    T& operator[](size_type i) { return fChunks[i >> fShift][i & fMask]; }
+    T const& operator[](size_type i) const { return fChunks[i >> fShift][i & fMask]; }
+    T& back() { return (*this)[fSize - 1]; }
+    T const& back() const { return (*this)[fSize - 1]; }
+
+    iterator begin() { return {this, 0}; }
+    iterator end() { return {this, fSize}; }
+    const_iterator begin() const { return {this, 0}; }
+    const_iterator end() const { return {this, fSize}; }
+
+    /// Copies the hits into a contiguous collection with a single, exactly
+    /// sized allocation.
+    template <typename Collection = std::vector<T>>
+    Collection to_collection() const
+    {
+      Collection result;
+      result.reserve(fSize);
+      for (size_type i = 0, n = usedChunks(); i != n; ++i)
+        result.insert(result.end(), fChunks[i].begin(), fChunks[i].end());
+      return result;
+    }
+
+  private:
+    size_type usedChunks() const { return (fSize + fMask) >> fShift; }
+
+    void addChunk()
+    {
+      fChunks.emplace_back();
+      fChunks.back().reserve(fMask + 1);
+    }
+
+    template <bool Const>
+    class basic_iterator {
+      using arena_t = std::conditional_t<Const, HitArena const, HitArena>;
+
+    public:
+      using iterator_category = std::random_access_iterator_tag;
+      using value_type = T;
+      using difference_type = std::ptrdiff_t;
+      using pointer = std::conditional_t<Const, T const*, T*>;
+      using reference = std::conditional_t<Const, T const&, T&>;
+
+      basic_iterator() = default;
+      basic_iterator(arena_t* arena, size_type index) : fArena{arena}, fIndex{index} {}
+
+      reference operator*() const { return (*fArena)[fIndex]; }
+      pointer operator->() const { return &(*fArena)[fIndex]; }
+      reference operator[](difference_type n) const { return (*fArena)[fIndex + n]; }
+
+      basic_iterator& operator++()
+      {
+        ++fIndex;
+        return *this;
+      }
+      basic_iterator operator++(int)
+      {
+        auto tmp = *this;
+        ++fIndex;
+        return tmp;
+      }
+      basic_iterator& operator--()
+      {
+        --fIndex;
+        return *this;
+      }
+      basic_iterator operator--(int)
+      {
+        auto tmp = *this;
+        --fIndex;
+        return tmp;
+      }
+      basic_iterator& operator+=(difference_type n)
+      {
+        fIndex += n;
+        return *this;
+      }
+      basic_iterator& operator-=(difference_type n)
+      {
+        fIndex -= n;
+        return *this;
+      }
+      friend basic_iterator operator+(basic_iterator it, difference_type n) { return it += n; }
+      friend basic_iterator operator+(difference_type n, basic_iterator it) { return it += n; }
+      friend basic_iterator operator-(basic_iterator it, difference_type n) { return it -= n; }
+      friend difference_type operator-(basic_iterator const& a, basic_iterator const& b)
+      {
+        return static_cast<difference_type>(a.fIndex) - static_cast<difference_type>(b.fIndex);
+      }
+      friend bool operator==(basic_iterator const& a, basic_iterator const& b)
+      {
+        return a.fIndex == b.fIndex;
+      }
+      friend bool operator!=(basic_iterator const& a, basic_iterator const& b)
+      {
+        return a.fIndex != b.fIndex;
+      }
+      friend bool operator<(basic_iterator const& a, basic_iterator const& b)
+      {
+        return a.fIndex < b.fIndex;
+      }
+      friend bool operator>(basic_iterator const& a, basic_iterator const& b) { return b < a; }
+      friend bool operator<=(basic_iterator const& a, basic_iterator const& b) { return !(b < a); }
+      friend bool operator>=(basic_iterator const& a, basic_iterator const& b) { return !(a < b); }
+
+    private:
+      arena_t* fArena{nullptr};
+      size_type fIndex{0};
+    };
+
+    std::vector<std::vector<T>> fChunks; ///< each chunk is reserved once and never grows
+    std::vector<size_type> fHistory;     ///< hit counts of the last events
+    size_type fHistoryPos{0};
+    size_type fSize{0};
+    size_type fShift{0};
+    size_type fMask{0};
+  };
+
+} // namespace larg4
+
+#endif // LARG4_SERVICES_HITARENA_H
@@ -23,10 +23,20 @@
 // framework includes:
 #include "art/Framework/Core/ProducesCollector.h"
 #include "cetlib/search_path.h"
+#include "larcore/CoreUtils/ServiceUtil.h" // for lar::providerFrom
+#include "larcore/Geometry/AuxDetGeometry.h"
+#include "larcore/Geometry/Geometry.h"
+#include "larcorealg/Geometry/GeometryCore.h"
 // larg4 includes:
 #include "larg4/Services/AuxDetSD.h"
+#include "larg4/Services/GeometryCache.h"
 #include "larg4/Services/LArG4Detector_service.h"
+#include "larg4/Services/FrozenShowerModel.h"
+#include "larg4/Services/MuonFastTransportModel.h"
+#include "larg4/Services/OpticalPhotonFastModel.h"
+#include "larg4/Services/OverlapCheck.h"
 #include "larg4/Services/SimEnergyDepositSD.h"
+#include "larg4/Services/TGeoToG4.h"
 #include "larg4/pluginActions/ParticleListAction_service.h"
 // artg4tk includes:
 #include "artg4tk/pluginDetectors/gdml/ByParticle.hh"
@@ -43,25 +53,45 @@
 #include "artg4tk/pluginDetectors/gdml/TrackerSD.hh"
 //lardataobj includes:
 #include "lardataobj/Simulation/AuxDetHit.h"
+#include "lardataobj/Simulation/AuxDetSimChannel.h"
 #include "lardataobj/Simulation/SimEnergyDeposit.h"
+#include "lardataobj/Simulation/SimPhotons.h"
 // Geant 4 includes:
+#include "Geant4/G4AffineTransform.hh"
 #include "Geant4/G4AutoDelete.hh"
+#include "Geant4/G4Electron.hh"
 #include "Geant4/G4GDMLParser.hh"
 #include "Geant4/G4LogicalVolume.hh"
 #include "Geant4/G4LogicalVolumeStore.hh"
 #include "Geant4/G4PhysicalVolumeStore.hh"
+#include "Geant4/G4Positron.hh"
+#include "Geant4/G4Region.hh"
 #include "Geant4/G4RegionStore.hh"
+#include "Geant4/G4RotationMatrix.hh"
 #include "Geant4/G4SDManager.hh"
 #include "Geant4/G4StepLimiter.hh"
+#include "Geant4/G4ThreeVector.hh"
 #include "Geant4/G4Types.hh"
 #include "Geant4/G4UnitsTable.hh"
 #include "Geant4/G4UserLimits.hh"
 #include "Geant4/G4VPhysicalVolume.hh"
+#include "Geant4/G4VSolid.hh"
 #include "Geant4/G4VUserDetectorConstruction.hh"
+#include "Geant4/GFlashHitMaker.hh"
+#include "Geant4/GFlashHomoShowerParameterisation.hh"
+#include "Geant4/GFlashParticleBounds.hh"
+#include "Geant4/GFlashShowerModel.hh"
 #include "Geant4/globals.hh"
 
 // C++ includes
+#include <algorithm>
+#include <cfloat>
+#include <future>
+#include <memory>
+#include <optional>
+#include <set>
 #include <unordered_map>
+#include <utility>
 
 using std::string;
 
@@ -71,6 +101,122 @@ namespace {
   {
     return std::make_unique<T>(std::move(t));
   }
+
+  template <typename SD>
+  SD* checked_cast(G4VSensitiveDetector* sd,
+                   std::string const& volume_name,
+                   std::string const& sd_name)
+  {
+    auto result = dynamic_cast<SD*>(sd);
+    if (!result) {
+      throw cet::exception("LArG4DetectorService")
+        << "Sensitive detector " << volume_name << "_" << sd_name
+        << " not found or not of the expected type.\n";
+    }
+    return result;
+  }
+
+  // Appends the hits of one Geant4 event to those collected for the art event
+  template <typename T>
+  void accumulate(std::vector<T>& collected, std::vector<T> hits)
+  {
+    if (collected.empty()) {
+      collected = std::move(hits);
+      return;
+    }
+    collected.insert(
+      collected.end(), std::make_move_iterator(hits.begin()), std::make_move_iterator(hits.end()));
+  }
+
+  template <typename K, typename V>
+  void accumulate(std::map<K, V>& collected, std::map<K, V> const& sums)
+  {
+    for (auto const& [key, value] : sums) {
+      collected[key] += value;
+    }
+  }
+
+  // Track ID to store downstream; tracks unknown to ParticleListActionService map to 0
+  int targetID(std::map<int, int> const& tmap, int trackID)
+  {
+    auto const it = tmap.find(trackID);
+    return it == tmap.end() ? 0 : it->second;
+  }
+
+  // Copy of the target IDs of the tracks of one sub-event (those from its
+  // offset on), which another thread can read while Geant4 adds the tracks of
+  // the next sub-event to the map
+  using TargetIDs = std::vector<std::pair<int, int>>;
+
+  TargetIDs targetIDsFrom(std::map<int, int> const& tmap, int trackIDOffset)
+  {
+    return {tmap.lower_bound(trackIDOffset), tmap.end()};
+  }
+
+  int targetID(TargetIDs const& ids, int trackID)
+  {
+    auto const it = std::partition_point(
+      ids.begin(), ids.end(), [trackID](auto const& id) { return id.first < trackID; });
+    return it == ids.end() || it->first != trackID ? 0 : it->second;
+  }
+
+  // Adds the sub-event offset to the Geant4 track IDs of the hits and, with
+  // `update`, translates them into the IDs stored downstream
+  template <typename IDs>
+  void remapTrackIDs(sim::SimEnergyDepositCollection& hits,
+                     IDs const& ids,
+                     int trackIDOffset,
+                     bool update)
+  {
+    for (auto& hit : hits) {
+      int const trackID = hit.TrackID() + trackIDOffset;
+      hit.setTrackID(update ? targetID(ids, trackID) : trackID);
+      if (trackIDOffset != 0) {
+        hit.setOrigTrackID(hit.OrigTrackID() + trackIDOffset);
+      }
+    }
+  }
+
+  template <typename IDs>
+  void remapTrackIDs(sim::AuxDetHitCollection& hits, IDs const& ids, int trackIDOffset, bool update)
+  {
+    for (auto& hit : hits) {
+      int const trackID = hit.GetTrackID() + trackIDOffset;
+      hit.SetTrackID(update ? targetID(ids, trackID) : trackID);
+    }
+  }
+
+  // Hits of the sub-events of one art event.  The hits of a sub-event are
+  // remapped either on a thread of their own, while Geant4 tracks the next
+  // sub-event, or when joined; join() returns them in sub-event order.
+  template <typename Collection>
+  class SubEventHits {
+  public:
+    template <typename Remap>
+    void add(Collection hits, Remap remap, bool async)
+    {
+      chunks_->push_back(std::async(async ? std::launch::async : std::launch::deferred,
+                                    [hits = std::move(hits), remap = std::move(remap)]() mutable {
+                                      remap(hits);
+                                      return std::move(hits);
+                                    }));
+    }
+
+    Collection join()
+    {
+      Collection result;
+      for (auto& chunk : *chunks_) {
+        accumulate(result, chunk.get());
+      }
+      chunks_->clear();
+      return result;
+    }
+
+  private:
+    // shared, so that the filler holding it stays copyable
+    std::shared_ptr<std::vector<std::future<Collection>>> chunks_ =
+      std::make_shared<std::vector<std::future<Collection>>>();
+  };
 }
 
 larg4::LArG4DetectorService::LArG4DetectorService(fhicl::ParameterSet const& p)
@@ -86,6 +232,25 @@ larg4::LArG4DetectorService::LArG4DetectorService(fhicl::ParameterSet const& p)
   , stepLimits_{p.get<std::vector<float>>("stepLimits", {})}
   , inputVolumes_{size(volumeNames_)}
   , dumpMP_{p.get<bool>("DumpMaterialProperties", false)}
+  , hitArenaChunkSize_{p.get<size_t>("HitArenaChunkSize", 4096)}
+  , hitArenaHistory_{p.get<size_t>("HitArenaHistory", 8)}
+  , simEnergyDepositOptions_{p.get<std::vector<std::string>>("SimEnergyDepositOptions", {})}
+  , auxDetOptions_{p.get<std::vector<std::string>>("AuxDetOptions", {})}
+  , geometryCacheDir_{p.get<std::string>("GeometryCacheDir", "")}
+  , buildFromTGeo_{p.get<bool>("BuildFromTGeo", false)}
+  , overlapCheckDir_{p.get<std::string>("OverlapCheckDir", "")}
+  , asyncHitRemapping_{p.get<bool>("AsyncHitRemapping", false)}
+  , fastMuonMinEnergy_{p.get<double>("FastMuonMinEnergy", 1.) * CLHEP::GeV}
+  , fastMuonExitLayer_{p.get<double>("FastMuonExitLayer", 50.) * CLHEP::cm}
+  , parameterizedShowerMinEnergy_{p.get<double>("ParameterizedShowerMinEnergy", 1.) * CLHEP::GeV}
+  , parameterizedShowerMaxEnergy_{p.get<double>("ParameterizedShowerMaxEnergy", 1000.) *
+                                  CLHEP::GeV}
+  , frozenShowerLibraryName_{p.get<std::string>("FrozenShowerLibrary", "")}
+  , frozenShowerMaxEnergy_{p.get<double>("FrozenShowerMaxEnergy", 50.) * CLHEP::MeV}
+  , opticalFastSimulation_{p.get<bool>("OpticalFastSimulation", false)}
+  , opticalVisibilityTable_{p.get<std::string>("OpticalVisibilityTable", "")}
+  , opticalAttenuationLength_{p.get<double>("OpticalAttenuationLength", 2000.) * CLHEP::cm}
+  , opticalEfficiency_{p.get<double>("OpticalDetectionEfficiency", 1.)}
 {
   // Make sure units are defined.
   G4UnitDefinition::GetUnitsTable();
@@ -97,6 +262,10 @@ larg4::LArG4DetectorService::LArG4DetectorService(fhicl::ParameterSet const& p)
                                                  << "\n";
   }
 
+  // -- Validate the default SD options early (throws on unknown options)
+  SimEnergyDepositSDOptions{}.apply(simEnergyDepositOptions_);
+  AuxDetSDOptions{}.apply(auxDetOptions_);
+
   //-- define commonly used units, that we might need
   new G4UnitDefinition("volt/cm", "V/cm", "Electric field", CLHEP::volt / CLHEP::cm);
 
@@ -129,8 +298,62 @@ std::vector<G4LogicalVolume*> larg4::LArG4DetectorService::doBuildLVs()
   if (!sp.find_file(gdmlFileName_, fullGDMLFileName)) {
     throw cet::exception("LArG4DetectorService") << "Cannot find file: " << gdmlFileName_;
   }
-  parser.Read(fullGDMLFileName, false);
-  G4VPhysicalVolume* World = parser.GetWorldVolume();
+
+  // -- Convert the TGeo geometry geo::Geometry has already loaded, or rebuild
+  //    the geometry from the binary cache when it matches the GDML content;
+  //    otherwise parse the GDML file and refresh the cache.  The overlap
+  //    check is only done by the parser, so it bypasses the cache.
+  G4VPhysicalVolume* World = nullptr;
+  G4GDMLAuxMapType cachedAuxMap;
+  const G4GDMLAuxMapType* auxmap = &cachedAuxMap;
+  std::optional<GeometryCache> cache;
+  std::optional<TGeoToG4> converter;
+  if (buildFromTGeo_) {
+    auto const& geom = *lar::providerFrom<geo::Geometry>();
+    auto baseName = [](std::string const& path) { return path.substr(path.find_last_of('/') + 1); };
+    if (baseName(geom.GDMLFile()) != baseName(fullGDMLFileName)) {
+      MF_LOG_WARNING("LArG4DetectorService::doBuildLVs")
+        << "Building the Geant4 geometry from the geometry loaded by geo::Geometry ("
+        << geom.GDMLFile() << "), which is not " << fullGDMLFileName;
+    }
+    converter.emplace(checkOverlaps_);
+    World = converter->convert(*geom.ROOTGeoManager());
+    auxmap = &converter->readAuxiliaryMap(geom.GDMLFile());
+  }
+  else if (!geometryCacheDir_.empty()) {
+    cache.emplace(geometryCacheDir_, fullGDMLFileName);
+    if (!checkOverlaps_) { World = cache->load(cachedAuxMap); }
+  }
+  if (!World) {
+    parser.Read(fullGDMLFileName, false);
+    World = parser.GetWorldVolume();
+    auxmap = parser.GetAuxMap();
+    if (cache) { cache->store(World, *auxmap); }
+  }
+
+  // -- Report the result of the offline overlap check (larg4CheckOverlaps)
+  if (!overlapCheckDir_.empty()) {
+    auto const hash = cache ? cache->hash() : GeometryCache::contentHash(fullGDMLFileName);
+    auto const resultFileName = overlapResultFileName(overlapCheckDir_, fullGDMLFileName, hash);
+    auto const result = readOverlapResult(resultFileName);
+    if (!result || result->gdmlHash != hash) {
+      mf::LogInfo("LArG4DetectorService::doBuildLVs")
+        << "Geometry not verified: no overlap check result " << resultFileName
+        << "; run larg4CheckOverlaps on " << fullGDMLFileName;
+    }
+    else if (result->overlaps.empty()) {
+      mf::LogInfo("LArG4DetectorService::doBuildLVs")
+        << "Geometry verified: no overlaps in " << result->placements << " placements ("
+        << result->points << " points each, tolerance " << result->tolerance << " mm).";
+    }
+    else {
+      mf::LogWarning log("LArG4DetectorService::doBuildLVs");
+      log << "Geometry has " << result->overlaps.size() << " overlap(s):";
+      for (auto const& overlap : result->overlaps) {
+        log << "\n  " << overlap;
+      }
+    }
+  }
 
   std::stringstream ss;
   ss << World->GetTranslation() << "\n\n";
@@ -143,15 +366,31 @@ std::vector<G4LogicalVolume*> larg4::LArG4DetectorService::doBuildLVs()
   ss << "Found " << pPVStore->size() << " physical volumes."
      << "\n\n";
   G4SDManager* SDman = G4SDManager::GetSDMpointer();
-  const G4GDMLAuxMapType* auxmap = parser.GetAuxMap();
   ss << "Found " << auxmap->size() << " volume(s) with auxiliary information."
      << "\n\n";
   ss << "%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%\n";
   mf::LogInfo("LArG4DetectorService::doBuildLVs") << ss.str();
 
+  sdRequests_.clear();
+  fastMuonRegions_.clear();
+  showerRegions_.clear();
+  frozenShowerRegions_.clear();
+  opticalRegions_.clear();
   for (auto const& [volume, auxes] : *auxmap) {
     G4cout << "Volume " << volume->GetName()
            << " has the following list of auxiliary information: \n";
+    // -- both shower models take over the e+/e- of their region: one at most
+    bool parameterizedShower = false;
+    bool frozenShowers = false;
+    for (auto const& aux : auxes) {
+      parameterizedShower |= (aux.type == "ParameterizedShower");
+      frozenShowers |= (aux.type == "FrozenShowers");
+    }
+    if (parameterizedShower && frozenShowers) {
+      throw cet::exception("LArG4DetectorService")
+        << "Volume " << volume->GetName()
+        << " is tagged both ParameterizedShower and FrozenShowers; keep one of them.\n";
+    }
     for (auto const& aux : auxes) {
       G4cout << "--> Type: " << aux.type << " Value: " << aux.value << "\n";
 
@@ -218,85 +457,75 @@ std::vector<G4LogicalVolume*> larg4::LArG4DetectorService::doBuildLVs()
       }
 
       if (aux.type == "SensDet") {
-        if (aux.value == "DRCalorimeter") {
-          G4String name = volume->GetName() + "_DRCalorimeter";
-          artg4tk::DRCalorimeterSD* aDRCalorimeterSD = new artg4tk::DRCalorimeterSD(name);
-          SDman->AddNewDetector(aDRCalorimeterSD);
-          volume->SetSensitiveDetector(aDRCalorimeterSD);
-          std::cout << "Attaching sensitive Detector: " << aux.value
-                    << " to Volume:  " << volume->GetName() << "\n";
-          detectors_.emplace_back(volume->GetName(), aux.value);
-        }
-        else if (aux.value == "Calorimeter") {
-          G4String name = volume->GetName() + "_Calorimeter";
-          artg4tk::CalorimeterSD* aCalorimeterSD = new artg4tk::CalorimeterSD(name);
-          SDman->AddNewDetector(aCalorimeterSD);
-          volume->SetSensitiveDetector(aCalorimeterSD);
-          std::cout << "Attaching sensitive Detector: " << aux.value
-                    << " to Volume:  " << volume->GetName() << "\n";
-          detectors_.emplace_back(volume->GetName(), aux.value);
-        }
-        else if (aux.value == "PhotonDetector") {
-          G4String name = volume->GetName() + "_PhotonDetector";
-          artg4tk::PhotonSD* aPhotonSD = new artg4tk::PhotonSD(name);
-          SDman->AddNewDetector(aPhotonSD);
-          volume->SetSensitiveDetector(aPhotonSD);
-          std::cout << "Attaching sensitive Detector: " << aux.value
-                    << " to Volume:  " << volume->GetName() << "\n";
-          detectors_.emplace_back(volume->GetName(), aux.value);
-        }
-        else if (aux.value == "Tracker") {
-          G4String name = volume->GetName() + "_Tracker";
-          artg4tk::TrackerSD* aTrackerSD = new artg4tk::TrackerSD(name);
-          SDman->AddNewDetector(aTrackerSD);
-          volume->SetSensitiveDetector(aTrackerSD);
-          std::cout << "Attaching sensitive Detector: " << aux.value
-                    << " to Volume:  " << volume->GetName() << "\n";
-          detectors_.push_back(std::make_pair(volume->GetName(), aux.value));
-        }
-        else if (aux.value == "SimEnergyDeposit") {
-          G4String name = volume->GetName() + "_SimEnergyDeposit";
-          SimEnergyDepositSD* aSimEnergyDepositSD = new SimEnergyDepositSD(name);
-          SDman->AddNewDetector(aSimEnergyDepositSD);
-          volume->SetSensitiveDetector(aSimEnergyDepositSD);
-          std::cout << "Attaching sensitive Detector: " << aux.value
-                    << " to Volume:  " << volume->GetName() << "\n";
-          detectors_.emplace_back(volume->GetName(), aux.value);
-        }
-        else if (aux.value == "AuxDet") {
-          G4String name = volume->GetName() + "_AuxDet";
-          AuxDetSD* aAuxDetSD = new AuxDetSD(name);
-          SDman->AddNewDetector(aAuxDetSD);
-          volume->SetSensitiveDetector(aAuxDetSD);
-          std::cout << "Attaching sensitive Detector: " << aux.value
-                    << " to Volume:  " << volume->GetName() << "\n";
-          detectors_.emplace_back(volume->GetName(), aux.value);
+        // -- the detectors are created by constructSensitiveDetectors()
+        sdRequests_.push_back({volume, aux.value});
+      }
+      if (aux.type == "FastMuonTransport") {
+        if (volume == World->GetLogicalVolume()) {
+          MF_LOG_WARNING("LArG4DetectorService::doBuildLVs")
+            << "FastMuonTransport ignored for the world volume " << volume->GetName()
+            << ": tag the rock and overburden volumes instead.";
+          continue;
         }
-        else if (aux.value == "HadInteraction") {
-          G4String name = volume->GetName() + "_HadInteraction";
-          artg4tk::HadInteractionSD* aHadInteractionSD = new artg4tk::HadInteractionSD(name);
-          // NOTE: This will be done in the HadInteractionSD ctor
-          // SDman->AddNewDetector(aHadInteractionSD);
-          volume->SetSensitiveDetector(aHadInteractionSD);
-          std::cout << "Attaching sensitive Detector: " << aux.value
-                    << " to Volume:  " << volume->GetName() << "\n";
-          detectors_.emplace_back(volume->GetName(), aux.value);
+        // -- the region is part of the geometry, the model is created by
+        //    constructFastSimulationModels()
+        auto region = new G4Region("FastMuonTransport_" + volume->GetName());
+        region->AddRootLogicalVolume(volume);
+        fastMuonRegions_.push_back(region);
+      }
+      if (aux.type == "ParameterizedShower") {
+        if (!volume->GetMaterial() || volume->GetNoDaughters() > 0) {
+          MF_LOG_WARNING("LArG4DetectorService::doBuildLVs")
+            << "ParameterizedShower ignored for " << volume->GetName()
+            << ": the shower parameterization needs a homogeneous volume without daughters.";
+          continue;
         }
-        else if (aux.value == "HadIntAndEdepTrk") {
-          G4String name = volume->GetName() + "_HadIntAndEdepTrk";
-          artg4tk::HadIntAndEdepTrkSD* aHadIntAndEdepTrkSD = new artg4tk::HadIntAndEdepTrkSD(name);
-          // NOTE: This will be done in the HadIntAndEdepTrkSD ctor
-          // SDman->AddNewDetector(aHadIntAndEdepTrkSD);
-          volume->SetSensitiveDetector(aHadIntAndEdepTrkSD);
-          std::cout << "Attaching sensitive Detector: " << aux.value
-                    << " to Volume:  " << volume->GetName() << "\n";
-          detectors_.emplace_back(volume->GetName(), aux.value);
+        // -- an energy value overrides ParameterizedShowerMinEnergy for this volume
+        G4double const minEnergy =
+          (provided_category == "Energy") ? value : parameterizedShowerMinEnergy_;
+        auto region = new G4Region("ParameterizedShower_" + volume->GetName());
+        region->AddRootLogicalVolume(volume);
+        showerRegions_.push_back({region, volume->GetMaterial(), minEnergy});
+      }
+      if (aux.type == "FrozenShowers") {
+        G4Region* region = volume->IsRootRegion() ? volume->GetRegion() : nullptr;
+        if (!region) {
+          region = new G4Region("FrozenShowers_" + volume->GetName());
+          region->AddRootLogicalVolume(volume);
         }
+        frozenShowerRegions_.push_back(region);
       }
     }
     std::cout
       << "%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%\n";
   }
+  if (!frozenShowerRegions_.empty()) {
+    cet::search_path sp{"FW_SEARCH_PATH"};
+    std::string fullLibraryName;
+    if (frozenShowerLibraryName_.empty() ||
+        !sp.find_file(frozenShowerLibraryName_, fullLibraryName)) {
+      throw cet::exception("LArG4DetectorService")
+        << "Volumes are tagged FrozenShowers, but the FrozenShowerLibrary \""
+        << frozenShowerLibraryName_ << "\" cannot be found.\n";
+    }
+    frozenShowerLibrary_ = std::make_unique<FrozenShowerLibrary>(fullLibraryName);
+  }
+  if (opticalFastSimulation_) {
+    for (auto const& [volume, sensDet] : sdRequests_) {
+      if (sensDet.rfind("SimEnergyDeposit", 0) != 0) continue;
+      G4Region* region = volume->IsRootRegion() ? volume->GetRegion() : nullptr;
+      if (!region) {
+        region = new G4Region("OpticalFastSimulation_" + volume->GetName());
+        region->AddRootLogicalVolume(volume);
+      }
+      opticalRegions_.push_back(region);
+    }
+  }
+  world_ = World;
+  constructSensitiveDetectors();
+  collectSensitiveBoundingBoxes();
+  constructFastSimulationModels();
+  makeHitFillers();
   if (dumpMP_) { G4cout << *(G4Material::GetMaterialTable()) << G4endl; }
   if (inputVolumes_ > 0) { setStepLimits(); }
   std::cout << "List SD Tree: \n";
@@ -316,6 +545,300 @@ std::vector<G4LogicalVolume*> larg4::LArG4DetectorService::doBuildLVs()
   return myLVvec;
 }
 
+void larg4::LArG4DetectorService::collectSensitiveBoundingBoxes()
+{
+  std::set<G4LogicalVolume const*> sensitive;
+  std::set<G4LogicalVolume const*> photonDetectors;
+  for (auto const& request : sdRequests_) {
+    sensitive.insert(request.volume);
+    if (request.sensDet.rfind("PhotonDetector", 0) == 0) photonDetectors.insert(request.volume);
+  }
+  sensitiveBoxes_.clear();
+  opticalDetectors_.clear();
+  if (sensitive.empty() || !world_) { return; }
+
+  // Box in the world frame around a solid placed with `toWorld`
+  auto worldBox = [](G4VSolid const& solid, G4AffineTransform const& toWorld) {
+    G4ThreeVector pmin, pmax;
+    solid.BoundingLimits(pmin, pmax);
+    BoundingBox box{G4ThreeVector(DBL_MAX, DBL_MAX, DBL_MAX),
+                    G4ThreeVector(-DBL_MAX, -DBL_MAX, -DBL_MAX)};
+    for (int corner = 0; corner < 8; ++corner) {
+      G4ThreeVector const local(corner & 1 ? pmax.x() : pmin.x(),
+                                corner & 2 ? pmax.y() : pmin.y(),
+                                corner & 4 ? pmax.z() : pmin.z());
+      G4ThreeVector const p = toWorld.TransformPoint(local);
+      box.min.set(std::min(box.min.x(), p.x()), std::min(box.min.y(), p.y()),
+                  std::min(box.min.z(), p.z()));
+      box.max.set(std::max(box.max.x(), p.x()), std::max(box.max.y(), p.y()),
+                  std::max(box.max.z(), p.z()));
+    }
+    return box;
+  };
+
+  // -- walk the placements depth first, in daughter order; daughters of a
+  //    sensitive volume lie inside its box, but may be photon detectors
+  struct Placement {
+    G4VPhysicalVolume const* pv;
+    G4AffineTransform toWorld;
+    bool inSensitive;
+  };
+  std::vector<Placement> placements{{world_, G4AffineTransform{}, false}};
+  while (!placements.empty()) {
+    auto const [pv, toWorld, inSensitive] = placements.back();
+    placements.pop_back();
+    G4LogicalVolume const* lv = pv->GetLogicalVolume();
+    bool const isSensitive = sensitive.count(lv);
+    if (isSensitive && !inSensitive) {
+      sensitiveBoxes_.push_back(worldBox(*lv->GetSolid(), toWorld));
+    }
+    if (photonDetectors.count(lv)) {
+      G4ThreeVector pmin, pmax;
+      lv->GetSolid()->BoundingLimits(pmin, pmax);
+      opticalDetectors_.push_back(
+        {toWorld.TransformPoint((pmin + pmax) / 2.), lv->GetSolid()->GetSurfaceArea()});
+    }
+    for (std::size_t i = lv->GetNoDaughters(); i-- > 0;) {
+      G4VPhysicalVolume const* daughter = lv->GetDaughter(i);
+      if (daughter->IsReplicated()) {
+        // -- replicas share one placement object; bound them by their mother
+        if (sensitive.count(daughter->GetLogicalVolume()) && !isSensitive && !inSensitive) {
+          sensitiveBoxes_.push_back(worldBox(*lv->GetSolid(), toWorld));
+        }
+        continue;
+      }
+      placements.push_back(
+        {daughter,
+         G4AffineTransform(daughter->GetRotation(), daughter->GetTranslation()) * toWorld,
+         inSensitive || isSensitive});
+    }
+  }
+  mf::LogInfo("LArG4DetectorService")
+    << "Collected " << sensitiveBoxes_.size() << " bounding boxes of sensitive volumes.";
+}
+
+void larg4::LArG4DetectorService::constructFastSimulationModels()
+{
+  if (opticalFastSimulation_) {
+    if (opticalVisibilityTable_.empty()) {
+      opticalVisibility_ = std::make_unique<SemiAnalyticVisibility>(
+        opticalDetectors_, opticalAttenuationLength_, opticalEfficiency_);
+    }
+    else {
+      cet::search_path sp{"FW_SEARCH_PATH"};
+      std::string fullTableName;
+      if (!sp.find_file(opticalVisibilityTable_, fullTableName)) {
+        throw cet::exception("LArG4DetectorService")
+          << "Cannot find visibility table " << opticalVisibilityTable_ << "\n";
+      }
+      opticalVisibility_ = std::make_unique<TableVisibility>(fullTableName);
+    }
+    if (opticalVisibility_->nDetectors() != opticalDetectors_.size()) {
+      throw cet::exception("LArG4DetectorService")
+        << "The optical visibility model has " << opticalVisibility_->nDetectors()
+        << " detectors, the geometry " << opticalDetectors_.size() << " PhotonDetector volumes.\n";
+    }
+    fastOpticalPhotons_.clear();
+    for (std::size_t i = 0; i < opticalDetectors_.size(); ++i) {
+      fastOpticalPhotons_.emplace_back(i);
+    }
+    for (G4Region* region : opticalRegions_) {
+      auto model = new OpticalPhotonFastModel(region->GetName() + "_OpticalPhotons",
+                                              region,
+                                              *opticalVisibility_,
+                                              opticalDetectors_,
+                                              fastOpticalPhotons_);
+      G4AutoDelete::Register(model);
+    }
+    mf::LogInfo("LArG4DetectorService")
+      << "Optical photons in " << opticalRegions_.size() << " regions replaced by "
+      << (opticalVisibilityTable_.empty() ? "semi-analytic" : "tabulated")
+      << " visibilities of " << opticalDetectors_.size() << " photon detectors.";
+  }
+
+  // -- like the sensitive detectors, the models are per thread
+  for (auto const& [region, material, minEnergy] : showerRegions_) {
+    auto parameterisation = new GFlashHomoShowerParameterisation(material);
+    auto bounds = new GFlashParticleBounds;
+    bounds->SetMinEneToParametrise(*G4Electron::Definition(), minEnergy);
+    bounds->SetMaxEneToParametrise(*G4Electron::Definition(), parameterizedShowerMaxEnergy_);
+    bounds->SetMinEneToParametrise(*G4Positron::Definition(), minEnergy);
+    bounds->SetMaxEneToParametrise(*G4Positron::Definition(), parameterizedShowerMaxEnergy_);
+    auto hitMaker = new GFlashHitMaker;
+    auto model = new GFlashShowerModel(region->GetName(), region);
+    model->SetParameterisation(*parameterisation);
+    model->SetParticleBounds(*bounds);
+    model->SetHitMaker(*hitMaker);
+    model->SetFlagParamOn(1);
+    G4AutoDelete::Register(model);
+    G4AutoDelete::Register(hitMaker);
+    G4AutoDelete::Register(bounds);
+    G4AutoDelete::Register(parameterisation);
+    mf::LogInfo("LArG4DetectorService")
+      << "Parameterized e+/e- showers from " << minEnergy / CLHEP::GeV << " to "
+      << parameterizedShowerMaxEnergy_ / CLHEP::GeV << " GeV in region " << region->GetName();
+  }
+  for (G4Region* region : frozenShowerRegions_) {
+    auto model = new FrozenShowerModel(
+      region->GetName() + "_FrozenShowers", region, *frozenShowerLibrary_, frozenShowerMaxEnergy_);
+    G4AutoDelete::Register(model);
+    mf::LogInfo("LArG4DetectorService")
+      << "Library showers below " << frozenShowerMaxEnergy_ / CLHEP::MeV << " MeV in region "
+      << region->GetName();
+  }
+  for (G4Region* region : fastMuonRegions_) {
+    auto model =
+      new MuonFastTransportModel(region->GetName(), region, fastMuonMinEnergy_, fastMuonExitLayer_);
+    G4AutoDelete::Register(model);
+    mf::LogInfo("LArG4DetectorService")
+      << "Fast muon transport above " << fastMuonMinEnergy_ / CLHEP::GeV << " GeV in region "
+      << region->GetName();
+  }
+}
+
+void larg4::LArG4DetectorService::constructSensitiveDetectors()
+{
+  // -- Sensitive detectors (and the hit filling bound to them) are attached to
+  //    the logical volumes separately from the geometry: Geant4 keeps the
+  //    volume -> detector assignment per thread, so with a multithreaded run
+  //    manager this has to be repeated on every worker thread, while the
+  //    volumes themselves are shared.
+  G4SDManager* SDman = G4SDManager::GetSDMpointer();
+  detectors_.clear();
+  bool needAuxDetChannels = false;
+  // -- the generator policy of the tracked particle decides what is recorded;
+  //    ParticleListActionService keeps it up to date while tracking
+  GeneratorPolicy const* const generatorPolicy =
+    art::ServiceHandle<larg4::ParticleListActionService>{}->CurrentGeneratorPolicy();
+  // -- a detector already made on this thread under the same name is
+  //    reattached rather than made and registered again; returns whether the
+  //    detector was made by `make`
+  auto attach = [SDman](G4LogicalVolume* volume, G4String const& name, auto make) {
+    G4VSensitiveDetector* sd = SDman->FindSensitiveDetector(name, false);
+    bool const made = (sd == nullptr);
+    if (made) { sd = make(name); }
+    volume->SetSensitiveDetector(sd);
+    return made;
+  };
+  for (auto const& [volume, sensDet] : sdRequests_) {
+    // -- the value may carry options, e.g. "SimEnergyDeposit:noPhotons"
+    std::vector<std::string> sdOptions;
+    std::string const sdType = splitSensDetValue(sensDet, sdOptions);
+    if (sensDet == "DRCalorimeter") {
+      attach(volume, volume->GetName() + "_DRCalorimeter", [SDman](G4String const& name) {
+        auto aDRCalorimeterSD = new artg4tk::DRCalorimeterSD(name);
+        SDman->AddNewDetector(aDRCalorimeterSD);
+        return aDRCalorimeterSD;
+      });
+      std::cout << "Attaching sensitive Detector: " << sensDet
+                << " to Volume:  " << volume->GetName() << "\n";
+      detectors_.emplace_back(volume->GetName(), sensDet);
+    }
+    else if (sensDet == "Calorimeter") {
+      attach(volume, volume->GetName() + "_Calorimeter", [SDman](G4String const& name) {
+        auto aCalorimeterSD = new artg4tk::CalorimeterSD(name);
+        SDman->AddNewDetector(aCalorimeterSD);
+        return aCalorimeterSD;
+      });
+      std::cout << "Attaching sensitive Detector: " << sensDet
+                << " to Volume:  " << volume->GetName() << "\n";
+      detectors_.emplace_back(volume->GetName(), sensDet);
+    }
+    else if (sensDet == "PhotonDetector") {
+      attach(volume, volume->GetName() + "_PhotonDetector", [SDman](G4String const& name) {
+        auto aPhotonSD = new artg4tk::PhotonSD(name);
+        SDman->AddNewDetector(aPhotonSD);
+        return aPhotonSD;
+      });
+      std::cout << "Attaching sensitive Detector: " << sensDet
+                << " to Volume:  " << volume->GetName() << "\n";
+      detectors_.emplace_back(volume->GetName(), sensDet);
+    }
+    else if (sensDet == "Tracker") {
+      attach(volume, volume->GetName() + "_Tracker", [SDman](G4String const& name) {
+        auto aTrackerSD = new artg4tk::TrackerSD(name);
+        SDman->AddNewDetector(aTrackerSD);
+        return aTrackerSD;
+      });
+      std::cout << "Attaching sensitive Detector: " << sensDet
+                << " to Volume:  " << volume->GetName() << "\n";
+      detectors_.push_back(std::make_pair(volume->GetName(), sensDet));
+    }
+    else if (sdType == "SimEnergyDeposit") {
+      SimEnergyDepositSDOptions options;
+      options.apply(simEnergyDepositOptions_);
+      options.apply(sdOptions);
+      attach(volume, volume->GetName() + "_SimEnergyDeposit", [&](G4String const& name) {
+        SimEnergyDepositSD* aSimEnergyDepositSD =
+          makeSimEnergyDepositSD(name, options, hitArenaChunkSize_, hitArenaHistory_);
+        aSimEnergyDepositSD->SetGeneratorPolicy(generatorPolicy);
+        SDman->AddNewDetector(aSimEnergyDepositSD);
+        return aSimEnergyDepositSD;
+      });
+      std::cout << "Attaching sensitive Detector: " << sensDet
+                << " to Volume:  " << volume->GetName() << "\n";
+      detectors_.emplace_back(volume->GetName(), sdType);
+    }
+    else if (sdType == "AuxDet") {
+      AuxDetSDOptions options;
+      options.apply(auxDetOptions_);
+      options.apply(sdOptions);
+      // -- the channel tables of reattached detectors are already filled
+      bool const made =
+        attach(volume, volume->GetName() + "_AuxDet", [&](G4String const& name) {
+          AuxDetSD* aAuxDetSD = new AuxDetSD(name, options, hitArenaChunkSize_, hitArenaHistory_);
+          aAuxDetSD->SetGeneratorPolicy(generatorPolicy);
+          SDman->AddNewDetector(aAuxDetSD);
+          return aAuxDetSD;
+        });
+      needAuxDetChannels |= made && options.simChannels;
+      std::cout << "Attaching sensitive Detector: " << sensDet
+                << " to Volume:  " << volume->GetName() << "\n";
+      detectors_.emplace_back(volume->GetName(), sdType);
+    }
+    else if (sensDet == "HadInteraction") {
+      attach(volume, volume->GetName() + "_HadInteraction", [](G4String const& name) {
+        // NOTE: AddNewDetector is done in the HadInteractionSD ctor
+        return new artg4tk::HadInteractionSD(name);
+      });
+      std::cout << "Attaching sensitive Detector: " << sensDet
+                << " to Volume:  " << volume->GetName() << "\n";
+      detectors_.emplace_back(volume->GetName(), sensDet);
+    }
+    else if (sensDet == "HadIntAndEdepTrk") {
+      attach(volume, volume->GetName() + "_HadIntAndEdepTrk", [](G4String const& name) {
+        // NOTE: AddNewDetector is done in the HadIntAndEdepTrkSD ctor
+        return new artg4tk::HadIntAndEdepTrkSD(name);
+      });
+      std::cout << "Attaching sensitive Detector: " << sensDet
+                << " to Volume:  " << volume->GetName() << "\n";
+      detectors_.emplace_back(volume->GetName(), sensDet);
+    }
+  }
+  if (needAuxDetChannels) { setAuxDetChannels(world_); }
+}
+
+void larg4::LArG4DetectorService::makeHitFillers()
+{
+  // -- Resolve the per-event hit filling of each detector once
+  hitFillers_.clear();
+  for (auto const& [volume_name, sd_name] : detectors_) {
+    if (auto filler = makeHitFiller(volume_name, sd_name)) {
+      hitFillers_.push_back(std::move(filler));
+    }
+  }
+  if (opticalFastSimulation_) {
+    // -- the counts of all sub-events are put with the last one
+    hitFillers_.push_back([this](art::Event& e, TargetIDMap const&, int, bool put) {
+      if (!put) { return; }
+      e.put(make_product(fastOpticalPhotons_), "FastOptical");
+      for (auto& photons : fastOpticalPhotons_) {
+        photons.DetectedPhotons.clear();
+      }
+    });
+  }
+}
+
 std::vector<G4VPhysicalVolume*> larg4::LArG4DetectorService::doPlaceToPVs(
   std::vector<G4LogicalVolume*>)
 {
@@ -387,6 +910,55 @@ void larg4::LArG4DetectorService::setStepLimits()
   } //--loop over input volumes
 } //--end of setStepLimit()
 
+void larg4::LArG4DetectorService::setAuxDetChannels(G4VPhysicalVolume const* world) const
+{
+  // -- Walk the placement tree once, accumulating the global transformation, and
+  //    ask the LArSoft geometry which AuxDet channel contains the origin of each
+  //    placement of a volume read out by an AuxDet SD producing sim channels.
+  auto const& auxDetGeom = art::ServiceHandle<geo::AuxDetGeometry const>()->GetProvider();
+  struct Placement {
+    G4VPhysicalVolume const* pv;
+    G4RotationMatrix rotation;
+    G4ThreeVector translation;
+  };
+  std::vector<Placement> toVisit{{world, G4RotationMatrix{}, G4ThreeVector{}}};
+  unsigned int nChannels = 0;
+  while (!empty(toVisit)) {
+    auto const [pv, rotation, translation] = toVisit.back();
+    toVisit.pop_back();
+    G4LogicalVolume const* lv = pv->GetLogicalVolume();
+    if (auto auxsd = dynamic_cast<AuxDetSD*>(lv->GetSensitiveDetector());
+        auxsd && auxsd->GetOptions().simChannels) {
+      geo::Point_t const origin{
+        translation.x() / CLHEP::cm, translation.y() / CLHEP::cm, translation.z() / CLHEP::cm};
+      std::size_t adID = 0, svID = 0;
+      try {
+        auxDetGeom.FindAuxDetSensitiveAtPosition(origin, adID, svID);
+      }
+      catch (cet::exception const& e) {
+        throw cet::exception("LArG4DetectorService", "", e)
+          << "Cannot find the AuxDet channel of volume " << pv->GetName() << " (copy number "
+          << pv->GetCopyNo() << ") placed at " << origin << " cm.\n";
+      }
+      auxsd->SetChannel(pv->GetCopyNo(), adID, svID);
+      ++nChannels;
+    }
+    for (std::size_t i = 0, n = lv->GetNoDaughters(); i < n; ++i) {
+      G4VPhysicalVolume const* daughter = lv->GetDaughter(i);
+      if (daughter->IsReplicated()) {
+        MF_LOG_WARNING("LArG4DetectorService::setAuxDetChannels")
+          << "Skipping replicated volume " << daughter->GetName();
+        continue;
+      }
+      toVisit.push_back({daughter,
+                         rotation * daughter->GetObjectRotationValue(),
+                         rotation * daughter->GetObjectTranslation() + translation});
+    }
+  }
+  mf::LogInfo("LArG4DetectorService::setAuxDetChannels")
+    << "Mapped " << nChannels << " AuxDet placement(s) to AuxDet channels.";
+}
+
 std::string larg4::LArG4DetectorService::instanceName(std::string const& volume_name) const
 {
   // Remove underscores from volume name because they are invalid in art instance names.
@@ -421,7 +993,17 @@ void larg4::LArG4DetectorService::doCallArtProduces(art::ProducesCollector& coll
       collector.produces<sim::SimEnergyDepositCollection>(instanceName(volume_name));
     }
     else if (sd_name == "AuxDet") {
-      collector.produces<sim::AuxDetHitCollection>(instanceName(volume_name));
+      auto const auxsd = checked_cast<AuxDetSD>(
+        G4SDManager::GetSDMpointer()->FindSensitiveDetector(volume_name + "_" + sd_name, false),
+        volume_name,
+        sd_name);
+      auto const& options = auxsd->GetOptions();
+      if (options.storeHits) {
+        collector.produces<sim::AuxDetHitCollection>(instanceName(volume_name));
+      }
+      if (options.simChannels) {
+        collector.produces<std::vector<sim::AuxDetSimChannel>>(instanceName(volume_name));
+      }
     }
     else if (sd_name == "HadInteraction") {
       collector.produces<artg4tk::ArtG4tkVtx>(); // do NOT use product instance name (for now)
@@ -431,82 +1013,170 @@ void larg4::LArG4DetectorService::doCallArtProduces(art::ProducesCollector& coll
       collector.produces<artg4tk::TrackerHitCollection>();
     }
   }
+  if (opticalFastSimulation_) {
+    collector.produces<std::vector<sim::SimPhotonsLite>>("FastOptical");
+  }
 }
 
-void larg4::LArG4DetectorService::doFillEventWithArtHits(G4HCofThisEvent* myHC)
+larg4::LArG4DetectorService::HitFiller larg4::LArG4DetectorService::makeHitFiller(
+  std::string const& volume_name,
+  std::string const& sd_name) const
 {
   //
   // NOTE(JVY): 1st hadronic interaction will be fetched as-is from HadInteractionSD
   //            a copy (via copy ctor) will be placed directly into art::Event
   //
-  G4SDManager* sdman = G4SDManager::GetSDMpointer();
+  // Each filler collects the hits of every Geant4 event of the art event (there is more than
+  // one when the primaries are tracked in sub-events) and puts them with the last one.
+  //
+  auto sd = G4SDManager::GetSDMpointer()->FindSensitiveDetector(volume_name + "_" + sd_name);
+  auto const instance = instanceName(volume_name);
+  if (sd_name == "HadInteraction") {
+    auto hisd = dynamic_cast<artg4tk::HadInteractionSD*>(sd);
+    if (!hisd) { return {}; }
+    return [hisd, first = std::optional<artg4tk::ArtG4tkVtx>{}](
+             art::Event& e, TargetIDMap const&, int, bool put) mutable {
+      if (auto const& inter = hisd->Get1stInteraction(); !first && inter.GetNumOutcoming() > 0) {
+        first = inter;
+      }
+      hisd->clear();
+      if (put && first) { e.put(make_product(std::move(*first))); }
+      if (put) { first.reset(); }
+    };
+  }
+  if (sd_name == "HadIntAndEdepTrk") {
+    auto trksd = dynamic_cast<artg4tk::HadIntAndEdepTrkSD*>(sd);
+    if (!trksd) { return {}; }
+    return [trksd,
+            first = std::optional<artg4tk::ArtG4tkVtx>{},
+            trkhits = artg4tk::TrackerHitCollection{}](
+             art::Event& e, TargetIDMap const&, int, bool put) mutable {
+      if (auto const& inter = trksd->Get1stInteraction(); !first && inter.GetNumOutcoming() > 0) {
+        first = inter;
+      }
+      accumulate(trkhits, trksd->GetEdepTrkHits());
+      trksd->clear();
+      if (!put) { return; }
+      if (first) { e.put(make_product(std::move(*first))); }
+      if (!trkhits.empty()) { e.put(make_product(std::exchange(trkhits, {}))); }
+      first.reset();
+    };
+  }
+  if (sd_name == "Tracker") {
+    auto trsd = checked_cast<artg4tk::TrackerSD>(sd, volume_name, sd_name);
+    return [trsd, instance, hits = artg4tk::TrackerHitCollection{}](
+             art::Event& e, TargetIDMap const&, int, bool put) mutable {
+      accumulate(hits, trsd->GetHits());
+      if (put) { e.put(make_product(std::exchange(hits, {})), instance); }
+    };
+  }
+  if (sd_name == "SimEnergyDeposit") {
+    auto sedsd = checked_cast<SimEnergyDepositSD>(sd, volume_name, sd_name);
+    return [sedsd,
+            instance,
+            update = updateSimEnergyDeposits_,
+            async = asyncHitRemapping_,
+            pending = SubEventHits<sim::SimEnergyDepositCollection>{}](
+             art::Event& e, TargetIDMap const& tmap, int trackIDOffset, bool put) mutable {
+      if (async && !put) {
+        pending.add(
+          sedsd->GetHits(),
+          [ids = update ? targetIDsFrom(tmap, trackIDOffset) : TargetIDs{}, trackIDOffset, update](
+            auto& hits) { remapTrackIDs(hits, ids, trackIDOffset, update); },
+          true);
+      }
+      else {
+        pending.add(
+          sedsd->GetHits(),
+          [&tmap, trackIDOffset, update](auto& hits) {
+            remapTrackIDs(hits, tmap, trackIDOffset, update);
+          },
+          false);
+      }
+      if (put) { e.put(make_product(pending.join()), instance); }
+    };
+  }
+  if (sd_name == "AuxDet") {
+    auto auxsd = checked_cast<AuxDetSD>(sd, volume_name, sd_name);
+    return [auxsd,
+            instance,
+            update = updateAuxDetHits_,
+            async = asyncHitRemapping_,
+            pending = SubEventHits<sim::AuxDetHitCollection>{}](
+             art::Event& e, TargetIDMap const& tmap, int trackIDOffset, bool put) mutable {
+      if (async && !put) {
+        pending.add(
+          auxsd->GetHits(),
+          [ids = update ? targetIDsFrom(tmap, trackIDOffset) : TargetIDs{}, trackIDOffset, update](
+            auto& hits) { remapTrackIDs(hits, ids, trackIDOffset, update); },
+          true);
+      }
+      else {
+        pending.add(
+          auxsd->GetHits(),
+          [&tmap, trackIDOffset, update](auto& hits) {
+            remapTrackIDs(hits, tmap, trackIDOffset, update);
+          },
+          false);
+      }
+      if (!put) { return; }
+      auto hitCollection = pending.join();
+      auto const& options = auxsd->GetOptions();
+      if (options.simChannels) {
+        e.put(make_product(auxsd->MakeSimChannels(hitCollection)), instance);
+      }
+      if (options.storeHits) { e.put(make_product(std::move(hitCollection)), instance); }
+    };
+  }
+  if (sd_name == "Calorimeter") {
+    auto calsd = checked_cast<artg4tk::CalorimeterSD>(sd, volume_name, sd_name);
+    return [calsd, instance, hits = artg4tk::CalorimeterHitCollection{}](
+             art::Event& e, TargetIDMap const&, int, bool put) mutable {
+      accumulate(hits, calsd->GetHits());
+      if (put) { e.put(make_product(std::exchange(hits, {})), instance); }
+    };
+  }
+  if (sd_name == "DRCalorimeter") {
+    auto drcalsd = checked_cast<artg4tk::DRCalorimeterSD>(sd, volume_name, sd_name);
+    return [drcalsd,
+            instance,
+            hits = artg4tk::DRCalorimeterHitCollection{},
+            edep = artg4tk::ByParticle{},
+            nceren = artg4tk::ByParticle{}](
+             art::Event& e, TargetIDMap const&, int, bool put) mutable {
+      accumulate(hits, drcalsd->GetHits());
+      accumulate(edep, drcalsd->GetEbyParticle());
+      accumulate(nceren, drcalsd->GetNCerenbyParticle());
+      if (!put) { return; }
+      e.put(make_product(std::exchange(hits, {})), instance);
+      e.put(make_product(std::exchange(edep, {})), instance + "Edep");
+      e.put(make_product(std::exchange(nceren, {})), instance + "NCeren");
+    };
+  }
+  if (sd_name == "PhotonDetector") {
+    auto phsd = checked_cast<artg4tk::PhotonSD>(sd, volume_name, sd_name);
+    return [phsd, instance, hits = artg4tk::PhotonHitCollection{}](
+             art::Event& e, TargetIDMap const&, int, bool put) mutable {
+      accumulate(hits, phsd->GetHits());
+      if (put) { e.put(make_product(std::exchange(hits, {})), instance); }
+    };
+  }
+  return {};
+}
+
+void larg4::LArG4DetectorService::doFillEventWithArtHits(G4HCofThisEvent*)
+{
+  // -- All string lookups and casts were resolved at the end of doBuildLVs
   art::ServiceHandle<artg4tk::DetectorHolderService> detectorHolder;
   art::Event& e = detectorHolder->getCurrArtEvent();
 
   //add in PartliceListActionService ...
   art::ServiceHandle<larg4::ParticleListActionService> particleListAction;
+  auto const& tmap = particleListAction->GetTargetIDMap();
+  int const trackIDOffset = particleListAction->GetSubEventTrackIDOffset();
+  bool const put = particleListAction->IsLastSubEvent();
 
-  for (auto const& [volume_name, sd_name] : detectors_) {
-    auto sd = sdman->FindSensitiveDetector(volume_name + "_" + sd_name);
-    if (sd_name == "HadInteraction") {
-      if (auto hisd = dynamic_cast<artg4tk::HadInteractionSD*>(sd)) {
-        if (auto const& inter = hisd->Get1stInteraction(); inter.GetNumOutcoming() > 0) {
-          e.put(make_product(inter));
-        }
-        hisd->clear();
-      }
-    }
-    else if (sd_name == "HadIntAndEdepTrk") {
-      if (auto trksd = dynamic_cast<artg4tk::HadIntAndEdepTrkSD*>(sd)) {
-        if (auto const& inter = trksd->Get1stInteraction(); inter.GetNumOutcoming() > 0) {
-          e.put(make_product(inter));
-        }
-        if (auto const& trkhits = trksd->GetEdepTrkHits(); !trkhits.empty()) {
-          e.put(make_product(trkhits));
-        }
-        trksd->clear();
-      }
-    }
-    else if (sd_name == "Tracker") {
-      auto trsd = dynamic_cast<artg4tk::TrackerSD*>(sd);
-      e.put(make_product(trsd->GetHits()), instanceName(volume_name));
-    }
-    else if (sd_name == "SimEnergyDeposit") {
-      auto sedsd = dynamic_cast<SimEnergyDepositSD*>(sd);
-      sim::SimEnergyDepositCollection hitCollection = sedsd->GetHits();
-      std::map<int, int> tmap = particleListAction->GetTargetIDMap();
-      if (updateSimEnergyDeposits_) {
-        for (auto& hit : hitCollection) {
-          hit.setTrackID(tmap[hit.TrackID()]);
-        }
-      }
-      e.put(make_product(hitCollection), instanceName(volume_name));
-    }
-    else if (sd_name == "AuxDet") {
-      auto auxsd = dynamic_cast<AuxDetSD*>(sd);
-      sim::AuxDetHitCollection hitCollection = auxsd->GetHits();
-      std::map<int, int> tmap = particleListAction->GetTargetIDMap();
-      if (updateAuxDetHits_) {
-        for (auto& hit : hitCollection) {
-          hit.SetTrackID(tmap[hit.GetTrackID()]);
-        }
-      }
-      e.put(make_product(auxsd->GetHits()), instanceName(volume_name));
-    }
-    else if (sd_name == "Calorimeter") {
-      auto calsd = dynamic_cast<artg4tk::CalorimeterSD*>(sd);
-      e.put(make_product(calsd->GetHits()), instanceName(volume_name));
-    }
-    else if (sd_name == "DRCalorimeter") {
-      auto drcalsd = dynamic_cast<artg4tk::DRCalorimeterSD*>(sd);
-      auto const identifier = instanceName(volume_name);
-      e.put(make_product(drcalsd->GetHits()), identifier);
-      e.put(make_product(drcalsd->GetEbyParticle()), identifier + "Edep");
-      e.put(make_product(drcalsd->GetNCerenbyParticle()), identifier + "NCeren");
-    }
-    else if (sd_name == "PhotonDetector") {
-      auto phsd = dynamic_cast<artg4tk::PhotonSD*>(sd);
-      e.put(make_product(phsd->GetHits()), instanceName(volume_name));
-    }
+  for (auto const& fill : hitFillers_) {
+    fill(e, tmap, trackIDOffset, put);
   }
 }
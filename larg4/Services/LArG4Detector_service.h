@@ -18,6 +18,10 @@
 //   }
 // }
 // </pre>
+// ParticleListActionService must be configured as well: it maps the Geant4
+// track IDs of the hits, and SimEnergyDepositSD and AuxDetSD ask it for the
+// GeneratorPolicy of the tracked particle, from the construction of the
+// sensitive detectors on.
 // Author: Hans Wenzel (Fermilab)
 // Modified: David Rivera - add ability to set step limits for different volumes
 //=============================================================================
@@ -28,8 +32,12 @@
 #include "artg4tk/Core/DetectorBase.hh"
 
 #include "art/Framework/Services/Registry/ServiceDeclarationMacros.h"
+#include "lardataobj/Simulation/SimPhotons.h"
+#include "larg4/Services/FrozenShowerLibrary.h"
+#include "larg4/Services/OpticalVisibility.h"
 
 namespace art {
+  class Event;
   class ProducesCollector;
 }
 
@@ -39,11 +47,17 @@ namespace fhicl {
 
 class G4HCofThisEvent;
 class G4LogicalVolume;
+class G4Material;
+class G4Region;
 class G4VPhysicalVolume;
+class G4VSensitiveDetector;
 
+#include "Geant4/G4ThreeVector.hh"
 #include "Geant4/G4Types.hh"
 
+#include <functional>
 #include <map>
+#include <memory>
 #include <string>
 #include <unordered_map>
 #include <utility>
@@ -55,6 +69,23 @@ namespace larg4 {
   public:
     explicit LArG4DetectorService(fhicl::ParameterSet const&);
 
+    // Create the sensitive detectors requested by the SensDet auxiliary tags
+    // and attach them to their volumes. Called from doBuildLVs; a Geant4
+    // worker thread would call it again from its ConstructSDandField().
+    // Detectors already made on the calling thread are reattached, not
+    // made again.
+    void constructSensitiveDetectors();
+
+    // Axis-aligned box in the world frame [mm]
+    struct BoundingBox {
+      G4ThreeVector min;
+      G4ThreeVector max;
+    };
+
+    // Bounding boxes of the placements of the volumes with a sensitive
+    // detector; available once the geometry is built.
+    std::vector<BoundingBox> const& sensitiveBoundingBoxes() const { return sensitiveBoxes_; }
+
   private:
     std::vector<G4LogicalVolume*> doBuildLVs() override;
     std::vector<G4VPhysicalVolume*> doPlaceToPVs(std::vector<G4LogicalVolume*>) override;
@@ -62,6 +93,20 @@ namespace larg4 {
     // -- D.R. Set the step limits for specific volumes from the configuration file
     void setStepLimits();
 
+    // Fill the copy number -> AuxDet channel tables of the AuxDet SDs producing sim channels
+    void setAuxDetChannels(G4VPhysicalVolume const* world) const;
+
+    // Attach the fast simulation models to their regions (per thread, like
+    // the sensitive detectors)
+    void constructFastSimulationModels();
+
+    // Fill sensitiveBoxes_ from the placements of the volumes in sdRequests_
+    void collectSensitiveBoundingBoxes();
+
+    // Fill hitFillers_ for the detectors in detectors_ and the fast optical
+    // simulation; once, after the detectors and models are constructed
+    void makeHitFillers();
+
     // We need to add something to the art event, so we need these two methods:
 
     std::string instanceName(std::string const&) const;
@@ -72,6 +117,15 @@ namespace larg4 {
     // Actually produce
     void doFillEventWithArtHits(G4HCofThisEvent* hc) override;
 
+    // Collects the hits of one detector at the end of each Geant4 event and
+    // puts them into the art event after the last one (`put`).  The offset is
+    // added to the Geant4 track IDs of the current sub-event and the map
+    // translates them into the IDs stored downstream.
+    using TargetIDMap = std::map<int, int>;
+    using HitFiller =
+      std::function<void(art::Event&, TargetIDMap const&, int trackIDOffset, bool put)>;
+    HitFiller makeHitFiller(std::string const& volume_name, std::string const& sd_name) const;
+
     std::string gdmlFileName_; // name of the gdml file
     bool checkOverlaps_;       // enable/disable check of overlaps
     bool
@@ -84,8 +138,52 @@ namespace larg4 {
       stepLimits_; // corresponding step limits to be set for each volume in the list of volumeNames, [mm]
     size_t inputVolumes_; // number of stepLimits to be set
     bool dumpMP_;         // enable/disable dump of material properties
+    size_t hitArenaChunkSize_; // number of hits per chunk of the SD hit arenas
+    size_t hitArenaHistory_;   // number of past events used to pre-size the SD hit arenas
+    std::vector<std::string>
+      simEnergyDepositOptions_; // options applied to every SimEnergyDeposit SD (e.g. noPhotons)
+    std::vector<std::string>
+      auxDetOptions_; // options applied to every AuxDet SD (e.g. simChannels)
+    std::string
+      geometryCacheDir_; // directory of the binary geometry cache (empty: no cache)
+    bool buildFromTGeo_; // convert the geometry loaded by geo::Geometry instead of parsing GDML
+    std::string overlapCheckDir_; // directory of the larg4CheckOverlaps results (empty: none)
+    bool asyncHitRemapping_; // remap the hits of a sub-event while the next one is tracked
+    G4double fastMuonMinEnergy_; // kinetic energy above which muons are transported fast
+    G4double fastMuonExitLayer_; // layer before the exit surface tracked in full
+    G4double parameterizedShowerMinEnergy_; // e+/e- energy range of the shower parameterization
+    G4double parameterizedShowerMaxEnergy_;
+    std::string frozenShowerLibraryName_; // library file of the FrozenShowers volumes
+    G4double frozenShowerMaxEnergy_;      // energy up to which library showers are used
+    bool opticalFastSimulation_; // replace optical photon tracking by visibilities
+    std::string opticalVisibilityTable_; // visibility table file (empty: semi-analytic model)
+    G4double opticalAttenuationLength_;  // of the semi-analytic model
+    G4double opticalEfficiency_;         // detection efficiency of the semi-analytic model
+
+    // Sensitive detector requested for a volume by its SensDet auxiliary tag
+    struct SDRequest {
+      G4LogicalVolume* volume;
+      std::string sensDet; // value of the tag, e.g. "SimEnergyDeposit:noPhotons"
+    };
+    std::vector<SDRequest> sdRequests_{};
+    G4VPhysicalVolume* world_{nullptr};
+    std::vector<BoundingBox> sensitiveBoxes_{};
+    std::vector<G4Region*> fastMuonRegions_{}; // volumes tagged FastMuonTransport
+    struct ShowerRegion {
+      G4Region* region;
+      G4Material* material;
+      G4double minEnergy;
+    };
+    std::vector<ShowerRegion> showerRegions_{}; // volumes tagged ParameterizedShower
+    std::vector<G4Region*> frozenShowerRegions_{}; // volumes tagged FrozenShowers
+    std::unique_ptr<FrozenShowerLibrary> frozenShowerLibrary_{};
+    std::vector<G4Region*> opticalRegions_{};  // regions of the SimEnergyDeposit volumes
+    std::vector<OpticalDetector> opticalDetectors_{}; // PhotonDetector placements, in walk order
+    std::unique_ptr<OpticalVisibility> opticalVisibility_{};
+    std::vector<sim::SimPhotonsLite> fastOpticalPhotons_{}; // counts of the current art event
 
     std::vector<std::pair<std::string, std::string>> detectors_{};
+    std::vector<HitFiller> hitFillers_{}; // resolved at the end of doBuildLVs
     std::map<std::string, G4double> overrideGDMLStepLimit_Map{};
     std::unordered_map<std::string, float>
       setGDMLVolumes_{}; // holds all <volume, steplimit> pairs set from the GDML file
@@ -0,0 +1,72 @@
+//=============================================================================
+// MappedFile.cc
+//=============================================================================
+
+#include "larg4/Services/MappedFile.h"
+
+#include "cetlib_except/exception.h"
+
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+larg4::MappedFile::MappedFile(std::string const& fileName) : fileName_{fileName}
+{
+  int const fd = ::open(fileName.c_str(), O_RDONLY);
+  if (fd < 0) {
+    throw cet::exception("MappedFile")
+      << "Cannot open " << fileName << ": " << std::strerror(errno) << "\n";
+  }
+  struct stat st;
+  if (::fstat(fd, &st) != 0) {
+    ::close(fd);
+    throw cet::exception("MappedFile")
+      << "Cannot stat " << fileName << ": " << std::strerror(errno) << "\n";
+  }
+  size_ = st.st_size;
+  if (size_ > 0) {
+    void* const address = ::mmap(nullptr, size_, PROT_READ, MAP_SHARED, fd, 0);
+    if (address == MAP_FAILED) {
+      ::close(fd);
+      throw cet::exception("MappedFile")
+        << "Cannot map " << fileName << ": " << std::strerror(errno) << "\n";
+    }
+    data_ = static_cast<char const*>(address);
+  }
+  // -- the mapping stays valid after the descriptor is closed
+  ::close(fd);
+}
+
+larg4::MappedFile::~MappedFile()
+{
+  if (data_) { ::munmap(const_cast<char*>(data_), size_); }
+}
+
+void larg4::writeFileAtomically(std::string const& fileName,
+                                std::initializer_list<std::string_view> pieces)
+{
+  // -- rename() replaces the file in one step: readers see the old or the
+  //    new file, and mappings of the old one stay valid
+  std::string const tmpName = fileName + ".tmp" + std::to_string(::getpid());
+  {
+    std::ofstream out{tmpName, std::ios::binary | std::ios::trunc};
+    for (auto const piece : pieces) {
+      out.write(piece.data(), piece.size());
+    }
+    if (!out) {
+      std::remove(tmpName.c_str());
+      throw cet::exception("MappedFile") << "Cannot write " << tmpName << ".\n";
+    }
+  }
+  if (std::rename(tmpName.c_str(), fileName.c_str()) != 0) {
+    int const error = errno;
+    std::remove(tmpName.c_str());
+    throw cet::exception("MappedFile")
+      << "Cannot create " << fileName << ": " << std::strerror(error) << "\n";
+  }
+}
@@ -0,0 +1,52 @@
+//=============================================================================
+// MappedFile.h:
+// Read-only memory mapping of a whole file.  The pages are shared by all the
+// processes mapping the same file, and only those touched are read.
+// Files meant to be mapped (or read) by concurrent jobs are written with
+// writeFileAtomically(), so that no job sees a partial file.
+//=============================================================================
+
+#ifndef LARG4_SERVICES_MAPPEDFILE_H
+#define LARG4_SERVICES_MAPPEDFILE_H
+
+#include <cstddef>
+#include <initializer_list>
+#include <string>
+#include <string_view>
+
+namespace larg4 {
+
+  class MappedFile {
+  public:
+    /// Maps `fileName`; throws cet::exception if it cannot be opened or mapped.
+    explicit MappedFile(std::string const& fileName);
+    ~MappedFile();
+
+    MappedFile(MappedFile const&) = delete;
+    MappedFile& operator=(MappedFile const&) = delete;
+
+    char const* data() const { return data_; }
+    std::size_t size() const { return size_; }
+    std::string const& fileName() const { return fileName_; }
+
+  private:
+    std::string fileName_;
+    char const* data_{nullptr};
+    std::size_t size_{0};
+  };
+
+  /// Writes the concatenated `pieces` to a temporary file next to `fileName`
+  /// and renames it to `fileName`; throws cet::exception on failure.
+  void writeFileAtomically(std::string const& fileName,
+                           std::initializer_list<std::string_view> pieces);
+
+  /// The bytes of the elements of a contiguous container, for writeFileAtomically().
+  template <typename Container>
+  std::string_view bytesOf(Container const& c)
+  {
+    return {reinterpret_cast<char const*>(c.data()), c.size() * sizeof(*c.data())};
+  }
+
+} // namespace larg4
+
+#endif // LARG4_SERVICES_MAPPEDFILE_H
@@ -0,0 +1,137 @@
+//=============================================================================
+// MuonFastTransportModel.cc
+//=============================================================================
+
+#include "larg4/Services/MuonFastTransportModel.h"
+
+#include "Geant4/G4AffineTransform.hh"
+#include "Geant4/G4FastStep.hh"
+#include "Geant4/G4FastTrack.hh"
+#include "Geant4/G4LogicalVolume.hh"
+#include "Geant4/G4Material.hh"
+#include "Geant4/G4MuonMinus.hh"
+#include "Geant4/G4MuonPlus.hh"
+#include "Geant4/G4SystemOfUnits.hh"
+#include "Geant4/G4VPhysicalVolume.hh"
+#include "Geant4/G4VSolid.hh"
+#include "Geant4/Randomize.hh"
+
+#include <algorithm>
+#include <cmath>
+
+namespace {
+  // Mean muon energy loss dE/dx = a + b E in standard rock; the ionization
+  // term includes the relativistic rise, the radiative term sums
+  // bremsstrahlung, pair production and photonuclear interactions.
+  constexpr G4double ionizationLoss = 2.2 * MeV * cm2 / g; // a / density
+  constexpr G4double radiativeLoss = 4.0e-6 * cm2 / g;     // b / density
+
+  // The remaining path must be longer than this for the model to be worth it
+  constexpr G4double minimumStep = 1. * cm;
+
+  // Kinetic energy after `length` of `material` with the mean energy loss
+  G4double energyAfter(G4double kineticEnergy, G4Material const& material, G4double length)
+  {
+    G4double const a = ionizationLoss * material.GetDensity();
+    G4double const b = radiativeLoss * material.GetDensity();
+    return (kineticEnergy + a / b) * std::exp(-b * length) - a / b;
+  }
+}
+
+larg4::MuonFastTransportModel::MuonFastTransportModel(G4String const& name,
+                                                      G4Region* region,
+                                                      G4double minEnergy,
+                                                      G4double exitLayer)
+  : G4VFastSimulationModel(name, region), fMinEnergy(minEnergy), fExitLayer(exitLayer)
+{}
+
+G4bool larg4::MuonFastTransportModel::IsApplicable(G4ParticleDefinition const& particle)
+{
+  return &particle == G4MuonMinus::Definition() || &particle == G4MuonPlus::Definition();
+}
+
+G4bool larg4::MuonFastTransportModel::ModelTrigger(G4FastTrack const& track)
+{
+  G4Track const* muon = track.GetPrimaryTrack();
+  if (muon->GetKineticEnergy() < fMinEnergy) return false;
+  // -- only in the envelope itself: daughters in the same region have their own frame
+  if (muon->GetVolume() != track.GetEnvelopePhysicalVolume()) return false;
+  G4double const length = distanceToExit(track) - fExitLayer;
+  if (length < minimumStep) return false;
+  // -- muons which would range out in the volume are left to the full simulation
+  G4Material const& material = *track.GetEnvelopeLogicalVolume()->GetMaterial();
+  return energyAfter(muon->GetKineticEnergy(), material, length) > fMinEnergy / 2.;
+}
+
+G4double larg4::MuonFastTransportModel::distanceToExit(G4FastTrack const& track) const
+{
+  G4ThreeVector const& position = track.GetPrimaryTrackLocalPosition();
+  G4ThreeVector const& direction = track.GetPrimaryTrackLocalDirection();
+  G4double distance = track.GetEnvelopeSolid()->DistanceToOut(position, direction);
+  G4LogicalVolume const* envelope = track.GetEnvelopeLogicalVolume();
+  for (std::size_t i = 0, n = envelope->GetNoDaughters(); i < n; ++i) {
+    G4VPhysicalVolume const* daughter = envelope->GetDaughter(i);
+    G4AffineTransform const toDaughter =
+      G4AffineTransform(daughter->GetRotation(), daughter->GetTranslation()).Inverse();
+    G4VSolid const* solid = daughter->GetLogicalVolume()->GetSolid();
+    distance = std::min(distance,
+                        solid->DistanceToIn(toDaughter.TransformPoint(position),
+                                            toDaughter.TransformAxis(direction)));
+  }
+  return distance;
+}
+
+void larg4::MuonFastTransportModel::DoIt(G4FastTrack const& track, G4FastStep& step)
+{
+  G4Track const* muon = track.GetPrimaryTrack();
+  G4ThreeVector const& position = track.GetPrimaryTrackLocalPosition();
+  G4ThreeVector const& direction = track.GetPrimaryTrackLocalDirection();
+  G4Material const* material = track.GetEnvelopeLogicalVolume()->GetMaterial();
+  G4double const length = distanceToExit(track) - fExitLayer;
+
+  // -- mean continuous energy loss over the path
+  G4double const kineticEnergy = muon->GetKineticEnergy();
+  G4double const mass = muon->GetDefinition()->GetPDGMass();
+  G4double const finalEnergy = energyAfter(kineticEnergy, *material, length);
+
+  // -- multiple scattering with the Highland formula at the mean momentum
+  auto momentum = [mass](G4double ekin) { return std::sqrt(ekin * (ekin + 2. * mass)); };
+  G4double const p = std::sqrt(momentum(kineticEnergy) * momentum(finalEnergy));
+  G4double const beta = p / std::sqrt(p * p + mass * mass);
+  G4double const t = length / material->GetRadlen();
+  G4double const theta0 = 13.6 * MeV / (beta * p) * std::sqrt(t) * (1. + 0.038 * std::log(t));
+
+  G4ThreeVector const u = direction.orthogonal().unit();
+  G4ThreeVector const v = direction.cross(u);
+  G4ThreeVector newDirection = direction;
+  G4ThreeVector displacement;
+  for (G4ThreeVector const& axis : {u, v}) {
+    G4double const z1 = G4RandGauss::shoot();
+    G4double const z2 = G4RandGauss::shoot();
+    newDirection += std::tan(z2 * theta0) * axis;
+    displacement += (z1 * length * theta0 / std::sqrt(12.) + z2 * length * theta0 / 2.) * axis;
+  }
+  newDirection = newDirection.unit();
+  // -- the displaced point must stay in the envelope, outside its daughters
+  G4ThreeVector newPosition = position + length * direction + displacement;
+  bool inEnvelope = track.GetEnvelopeSolid()->Inside(newPosition) == kInside;
+  G4LogicalVolume const* envelope = track.GetEnvelopeLogicalVolume();
+  for (std::size_t i = 0, n = envelope->GetNoDaughters(); inEnvelope && i < n; ++i) {
+    G4VPhysicalVolume const* daughter = envelope->GetDaughter(i);
+    G4AffineTransform const toDaughter =
+      G4AffineTransform(daughter->GetRotation(), daughter->GetTranslation()).Inverse();
+    inEnvelope = daughter->GetLogicalVolume()->GetSolid()->Inside(
+                   toDaughter.TransformPoint(newPosition)) == kOutside;
+  }
+  if (!inEnvelope) { newPosition = position + length * direction; }
+
+  G4double const dt = length / (beta * c_light);
+  step.ProposePrimaryTrackPathLength(length);
+  step.ProposeTotalEnergyDeposited(kineticEnergy - finalEnergy);
+  step.ProposePrimaryTrackFinalKineticEnergy(finalEnergy);
+  step.ProposePrimaryTrackFinalPosition(newPosition, true);
+  step.ProposePrimaryTrackFinalMomentumDirection(newDirection, true);
+  step.ProposePrimaryTrackFinalTime(muon->GetGlobalTime() + dt);
+  step.ProposePrimaryTrackFinalProperTime(muon->GetProperTime() +
+                                          dt * mass / (mass + kineticEnergy));
+}
@@ -0,0 +1,53 @@
+//=============================================================================
+// MuonFastTransportModel.h:
+// Fast transport of high-energy muons through passive volumes (rock,
+// overburden), attached by LArG4DetectorService to the volumes carrying the
+// GDML auxiliary tag "FastMuonTransport".
+//
+// A muon above the energy threshold is moved in one step to a layer of
+// configurable thickness before the exit surface of the volume (or the
+// surface of its first daughter on the way), with the mean continuous energy
+// loss dE/dx = a + b E and Gaussian multiple scattering (Highland formula,
+// with correlated lateral displacement).  The last layer is tracked by the
+// full physics, so the muon leaves the volume with realistic secondaries.
+// The model needs the fast simulation process for muons in the physics list
+// (larg4Main: fastSimulationParticles: ["mu-", "mu+"]).
+//=============================================================================
+
+#ifndef LARG4_SERVICES_MUONFASTTRANSPORTMODEL_H
+#define LARG4_SERVICES_MUONFASTTRANSPORTMODEL_H
+
+#include "Geant4/G4VFastSimulationModel.hh"
+
+class G4FastStep;
+class G4FastTrack;
+class G4ParticleDefinition;
+class G4Region;
+
+namespace larg4 {
+
+  class MuonFastTransportModel : public G4VFastSimulationModel {
+  public:
+    /// Kinetic energy above which muons are transported, and thickness of the
+    /// layer before the exit surface left to the full simulation.
+    MuonFastTransportModel(G4String const& name,
+                           G4Region* region,
+                           G4double minEnergy,
+                           G4double exitLayer);
+
+    G4bool IsApplicable(G4ParticleDefinition const& particle) override;
+    G4bool ModelTrigger(G4FastTrack const& track) override;
+    void DoIt(G4FastTrack const& track, G4FastStep& step) override;
+
+  private:
+    // Distance along the track to the exit surface of the envelope or to the
+    // surface of its nearest daughter, in the envelope frame
+    G4double distanceToExit(G4FastTrack const& track) const;
+
+    G4double fMinEnergy;
+    G4double fExitLayer;
+  };
+
+} // namespace larg4
+
+#endif // LARG4_SERVICES_MUONFASTTRANSPORTMODEL_H
@@ -0,0 +1,60 @@
+//=============================================================================
+// OpticalPhotonFastModel.cc
+//=============================================================================
+
+#include "larg4/Services/OpticalPhotonFastModel.h"
+
+#include "Geant4/G4FastStep.hh"
+#include "Geant4/G4FastTrack.hh"
+#include "Geant4/G4OpticalPhoton.hh"
+#include "Geant4/G4SystemOfUnits.hh"
+#include "Geant4/G4Track.hh"
+#include "Geant4/Randomize.hh"
+
+#include <cmath>
+
+namespace {
+  // Largest distance between emission points sharing their visibilities
+  constexpr G4double visibilityCacheDistance = 1. * cm;
+}
+
+larg4::OpticalPhotonFastModel::OpticalPhotonFastModel(G4String const& name,
+                                                      G4Region* region,
+                                                      OpticalVisibility const& visibility,
+                                                      std::vector<OpticalDetector> const& detectors,
+                                                      std::vector<sim::SimPhotonsLite>& photons)
+  : G4VFastSimulationModel(name, region)
+  , fVisibility(visibility)
+  , fDetectors(detectors)
+  , fPhotons(photons)
+{}
+
+G4bool larg4::OpticalPhotonFastModel::IsApplicable(G4ParticleDefinition const& particle)
+{
+  return &particle == G4OpticalPhoton::Definition();
+}
+
+void larg4::OpticalPhotonFastModel::DoIt(G4FastTrack const& track, G4FastStep& step)
+{
+  step.KillPrimaryTrack();
+  step.ProposePrimaryTrackPathLength(0.);
+
+  G4Track const* photon = track.GetPrimaryTrack();
+  G4ThreeVector const& position = photon->GetPosition();
+  if (fCachedVisibility.empty() ||
+      (position - fCachedPosition).mag2() > visibilityCacheDistance * visibilityCacheDistance) {
+    fVisibility.fill(position, fCachedVisibility);
+    fCachedPosition = position;
+  }
+
+  // -- one draw decides whether and where the photon is detected
+  G4double u = G4UniformRand();
+  for (std::size_t i = 0; i < fCachedVisibility.size(); ++i) {
+    u -= fCachedVisibility[i];
+    if (u >= 0.) continue;
+    G4double const distance = (fDetectors[i].center - position).mag();
+    G4double const time = photon->GetGlobalTime() + distance / photon->GetVelocity();
+    ++fPhotons[i].DetectedPhotons[static_cast<int>(std::floor(time / ns))];
+    return;
+  }
+}
@@ -0,0 +1,62 @@
+//=============================================================================
+// OpticalPhotonFastModel.h:
+// Fast simulation of the optical photons produced in the SimEnergyDeposit
+// volumes, attached by LArG4DetectorService when OpticalFastSimulation is
+// enabled.
+//
+// Each optical photon is killed at its first step.  Whether it is detected,
+// and by which photon detector, is drawn from the probabilities given by an
+// OpticalVisibility model for its emission point; a detected photon is
+// counted at its emission time plus the straight flight time to the
+// detector.  The counts of the art event are stored per detector as
+// sim::SimPhotonsLite, with the detector index as OpChannel.  The model
+// needs the fast simulation process for optical photons in the physics list
+// (larg4Main: fastSimulationParticles: ["opticalphoton"]).
+//=============================================================================
+
+#ifndef LARG4_SERVICES_OPTICALPHOTONFASTMODEL_H
+#define LARG4_SERVICES_OPTICALPHOTONFASTMODEL_H
+
+#include "larg4/Services/OpticalVisibility.h"
+
+#include "lardataobj/Simulation/SimPhotons.h"
+
+#include "Geant4/G4ThreeVector.hh"
+#include "Geant4/G4VFastSimulationModel.hh"
+
+#include <vector>
+
+class G4FastStep;
+class G4FastTrack;
+class G4ParticleDefinition;
+class G4Region;
+
+namespace larg4 {
+
+  class OpticalPhotonFastModel : public G4VFastSimulationModel {
+  public:
+    /// The detected photons are added to `photons`, one entry per detector.
+    OpticalPhotonFastModel(G4String const& name,
+                           G4Region* region,
+                           OpticalVisibility const& visibility,
+                           std::vector<OpticalDetector> const& detectors,
+                           std::vector<sim::SimPhotonsLite>& photons);
+
+    G4bool IsApplicable(G4ParticleDefinition const& particle) override;
+    G4bool ModelTrigger(G4FastTrack const&) override { return true; }
+    void DoIt(G4FastTrack const& track, G4FastStep& step) override;
+
+  private:
+    OpticalVisibility const& fVisibility;
+    std::vector<OpticalDetector> const& fDetectors;
+    std::vector<sim::SimPhotonsLite>& fPhotons;
+
+    // Photons of one step are emitted close to each other: the visibilities
+    // are reused while the emission point stays near the cached one.
+    G4ThreeVector fCachedPosition;
+    std::vector<G4double> fCachedVisibility;
+  };
+
+} // namespace larg4
+
+#endif // LARG4_SERVICES_OPTICALPHOTONFASTMODEL_H
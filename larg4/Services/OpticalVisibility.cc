@@ -0,0 +1,92 @@
+//=============================================================================
+// OpticalVisibility.cc
+//=============================================================================
+
+#include "larg4/Services/OpticalVisibility.h"
+
+#include "cetlib_except/exception.h"
+
+#include "Geant4/G4PhysicalConstants.hh"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <utility>
+
+//-----------------------------------------------------------------------------
+larg4::SemiAnalyticVisibility::SemiAnalyticVisibility(std::vector<OpticalDetector> detectors,
+                                                      G4double attenuationLength,
+                                                      G4double efficiency)
+  : fDetectors(std::move(detectors))
+  , fAttenuationLength(attenuationLength)
+  , fEfficiency(efficiency)
+{}
+
+void larg4::SemiAnalyticVisibility::fill(G4ThreeVector const& position,
+                                         std::vector<G4double>& visibility) const
+{
+  visibility.resize(fDetectors.size());
+  for (std::size_t i = 0; i < fDetectors.size(); ++i) {
+    OpticalDetector const& detector = fDetectors[i];
+    G4double const d2 = (detector.center - position).mag2();
+    // -- fraction of the sphere covered by the projected area, at most half of it
+    G4double const projected = detector.area / 4.;
+    G4double const acceptance = std::min(projected / (4. * pi * d2), 0.5);
+    visibility[i] = fEfficiency * acceptance * std::exp(-std::sqrt(d2) / fAttenuationLength);
+  }
+}
+
+//-----------------------------------------------------------------------------
+larg4::TableVisibility::TableVisibility(std::string const& fileName)
+{
+  std::ifstream in{fileName, std::ios::binary};
+  char magic[8];
+  std::uint32_t version = 0;
+  std::int32_t bins[3];
+  double min[3], max[3];
+  std::uint32_t nDetectors = 0;
+  in.read(magic, sizeof magic);
+  in.read(reinterpret_cast<char*>(&version), sizeof version);
+  in.read(reinterpret_cast<char*>(bins), sizeof bins);
+  in.read(reinterpret_cast<char*>(min), sizeof min);
+  in.read(reinterpret_cast<char*>(max), sizeof max);
+  in.read(reinterpret_cast<char*>(&nDetectors), sizeof nDetectors);
+  if (!in || std::memcmp(magic, "LARG4VIS", sizeof magic) != 0 || version != 1) {
+    throw cet::exception("OpticalVisibility")
+      << "File " << fileName << " is not a version 1 visibility table.\n";
+  }
+  std::size_t size = nDetectors;
+  for (int axis = 0; axis < 3; ++axis) {
+    if (bins[axis] <= 0 || !(max[axis] > min[axis])) {
+      throw cet::exception("OpticalVisibility") << "Invalid grid in " << fileName << ".\n";
+    }
+    fBins[axis] = bins[axis];
+    fMin[axis] = min[axis];
+    fMax[axis] = max[axis];
+    size *= bins[axis];
+  }
+  fNDetectors = nDetectors;
+  fVisibility.resize(size);
+  in.read(reinterpret_cast<char*>(fVisibility.data()), size * sizeof(float));
+  if (!in) {
+    throw cet::exception("OpticalVisibility") << "File " << fileName << " is truncated.\n";
+  }
+}
+
+void larg4::TableVisibility::fill(G4ThreeVector const& position,
+                                  std::vector<G4double>& visibility) const
+{
+  visibility.assign(fNDetectors, 0.);
+  std::size_t voxel = 0;
+  for (int axis = 0; axis < 3; ++axis) {
+    G4double const x = position[axis];
+    if (x < fMin[axis] || x >= fMax[axis]) return;
+    auto const bin = static_cast<std::size_t>((x - fMin[axis]) / (fMax[axis] - fMin[axis]) *
+                                              fBins[axis]);
+    voxel = voxel * fBins[axis] + std::min<std::size_t>(bin, fBins[axis] - 1);
+  }
+  auto const first = fVisibility.begin() + voxel * fNDetectors;
+  std::copy(first, first + fNDetectors, visibility.begin());
+}
@@ -0,0 +1,81 @@
+//=============================================================================
+// OpticalVisibility.h:
+// Models of the probability that a scintillation photon emitted at a given
+// point is detected by each photon detector, used by OpticalPhotonFastModel
+// in place of the tracking of the photons.
+//
+// - SemiAnalyticVisibility: solid angle of each detector seen from the
+//   emission point, with the orientation-averaged projected area of a convex
+//   body (a quarter of its surface), an exponential attenuation and a
+//   detection efficiency.
+// - TableVisibility: visibilities on a regular grid of voxels read from a
+//   binary file:
+//     char[8] "LARG4VIS", uint32 version (1),
+//     int32 nx, ny, nz, double min[3], max[3] [mm], uint32 nDetectors,
+//     float visibility[nx][ny][nz][nDetectors]
+//   Points outside the grid are not visible.
+//=============================================================================
+
+#ifndef LARG4_SERVICES_OPTICALVISIBILITY_H
+#define LARG4_SERVICES_OPTICALVISIBILITY_H
+
+#include "Geant4/G4ThreeVector.hh"
+#include "Geant4/G4Types.hh"
+
+#include <array>
+#include <cstddef>
+#include <string>
+#include <vector>
+
+namespace larg4 {
+
+  // Placement of a photon detector in the world frame
+  struct OpticalDetector {
+    G4ThreeVector center;
+    G4double area; ///< surface area [mm^2]
+  };
+
+  class OpticalVisibility {
+  public:
+    virtual ~OpticalVisibility() = default;
+
+    virtual std::size_t nDetectors() const = 0;
+
+    /// Fills `visibility` with the detection probability of a photon emitted
+    /// isotropically at `position` [mm], one entry per detector.
+    virtual void fill(G4ThreeVector const& position, std::vector<G4double>& visibility) const = 0;
+  };
+
+  class SemiAnalyticVisibility : public OpticalVisibility {
+  public:
+    SemiAnalyticVisibility(std::vector<OpticalDetector> detectors,
+                           G4double attenuationLength,
+                           G4double efficiency);
+
+    std::size_t nDetectors() const override { return fDetectors.size(); }
+    void fill(G4ThreeVector const& position, std::vector<G4double>& visibility) const override;
+
+  private:
+    std::vector<OpticalDetector> fDetectors;
+    G4double fAttenuationLength;
+    G4double fEfficiency;
+  };
+
+  class TableVisibility : public OpticalVisibility {
+  public:
+    explicit TableVisibility(std::string const& fileName);
+
+    std::size_t nDetectors() const override { return fNDetectors; }
+    void fill(G4ThreeVector const& position, std::vector<G4double>& visibility) const override;
+
+  private:
+    std::array<int, 3> fBins{};
+    std::array<G4double, 3> fMin{};
+    std::array<G4double, 3> fMax{};
+    std::size_t fNDetectors{};
+    std::vector<float> fVisibility;
+  };
+
+} // namespace larg4
+
+#endif // LARG4_SERVICES_OPTICALVISIBILITY_H
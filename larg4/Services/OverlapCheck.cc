@@ -0,0 +1,239 @@
+//=============================================================================
+// OverlapCheck.cc
+//=============================================================================
+
+#include "larg4/Services/OverlapCheck.h"
+
+#include "cetlib_except/exception.h"
+#include "messagefacility/MessageLogger/MessageLogger.h"
+
+#include "Geant4/G4AffineTransform.hh"
+#include "Geant4/G4LogicalVolume.hh"
+#include "Geant4/G4PVPlacement.hh"
+#include "Geant4/G4PhysicalVolumeStore.hh"
+#include "Geant4/G4Threading.hh"
+#include "Geant4/G4ThreeVector.hh"
+#include "Geant4/G4VSolid.hh"
+
+#include <algorithm>
+#include <atomic>
+#include <fstream>
+#include <iomanip>
+#include <map>
+#include <mutex>
+#include <sstream>
+#include <thread>
+#include <tuple>
+
+namespace {
+
+  constexpr int resultFormatVersion = 1;
+
+  // Surface points sampled ahead of one batch of checks, at most
+  constexpr std::size_t maxBatchPoints = std::size_t{1} << 22;
+
+  // A placement protruding from its mother (other == nullptr) or overlapping
+  // a sibling, with the largest depth found
+  struct Overlap {
+    G4VPhysicalVolume const* pv;
+    G4VPhysicalVolume const* other;
+    double depth;
+  };
+
+  std::string nameOf(G4VPhysicalVolume const* pv)
+  {
+    return pv->GetName() + ':' + std::to_string(pv->GetCopyNo());
+  }
+
+  // Checks one daughter, through the points sampled on its surface (in its
+  // own frame), against its mother and its siblings.
+  std::vector<Overlap> checkPlacement(G4VPhysicalVolume const* pv,
+                                      std::vector<G4ThreeVector> const& surface,
+                                      double tolerance)
+  {
+    G4LogicalVolume const* mother = pv->GetMotherLogical();
+    if (!mother) return {};
+    G4VSolid* motherSolid = mother->GetSolid();
+    G4AffineTransform const toMother(pv->GetRotation(), pv->GetTranslation());
+
+    std::vector<std::pair<G4VPhysicalVolume const*, G4AffineTransform>> siblings;
+    for (std::size_t i = 0, n = mother->GetNoDaughters(); i < n; ++i) {
+      G4VPhysicalVolume const* sibling = mother->GetDaughter(i);
+      if (sibling == pv) continue;
+      siblings.emplace_back(
+        sibling, G4AffineTransform(sibling->GetRotation(), sibling->GetTranslation()).Inverse());
+    }
+
+    double motherDepth = 0.;
+    std::map<G4VPhysicalVolume const*, double> siblingDepth;
+    for (G4ThreeVector const& point : surface) {
+      G4ThreeVector const mp = toMother.TransformPoint(point);
+      if (motherSolid->Inside(mp) == kOutside) {
+        motherDepth = std::max(motherDepth, motherSolid->DistanceToIn(mp));
+      }
+      for (auto const& [sibling, toSibling] : siblings) {
+        G4VSolid const* siblingSolid = sibling->GetLogicalVolume()->GetSolid();
+        G4ThreeVector const sp = toSibling.TransformPoint(mp);
+        if (siblingSolid->Inside(sp) != kInside) continue;
+        auto& depth = siblingDepth[sibling];
+        depth = std::max(depth, siblingSolid->DistanceToOut(sp));
+      }
+    }
+
+    std::vector<Overlap> result;
+    if (motherDepth > tolerance) result.push_back({pv, nullptr, motherDepth});
+    for (auto const& [sibling, depth] : siblingDepth) {
+      if (depth > tolerance) result.push_back({pv, sibling, depth});
+    }
+    return result;
+  }
+
+  // One description per protruding placement and per overlapping pair of
+  // siblings: a pair is found from both sides, with the deeper one kept.
+  std::vector<std::string> describe(std::vector<Overlap> const& overlaps)
+  {
+    // (protrusion, placement, mother or sibling) -> depth
+    std::map<std::tuple<bool, std::string, std::string>, double> depths;
+    for (auto const& [pv, other, depth] : overlaps) {
+      std::string self = nameOf(pv);
+      std::string what = other ? nameOf(other) : pv->GetMotherLogical()->GetName();
+      if (other && what < self) std::swap(self, what);
+      auto& maxDepth = depths[{other == nullptr, self, what}];
+      maxDepth = std::max(maxDepth, depth);
+    }
+    std::vector<std::string> result;
+    for (auto const& [key, depth] : depths) {
+      auto const& [protrusion, self, what] = key;
+      std::ostringstream s;
+      s << self << (protrusion ? " protrudes from mother " : " overlaps ") << what << " by "
+        << depth << " mm";
+      result.push_back(s.str());
+    }
+    std::sort(result.begin(), result.end());
+    return result;
+  }
+
+} // namespace
+
+//-----------------------------------------------------------------------------
+unsigned larg4::overlapCheckThreads(unsigned requested)
+{
+#ifndef G4MULTITHREADED
+  // -- the G4ThreadLocal caches of the solids are plain statics in a
+  //    sequential Geant4 build: the threads would share them
+  if (requested > 1) {
+    mf::LogWarning("OverlapCheck")
+      << "Geant4 is built without multithreading: checking with one thread instead of "
+      << requested << ".";
+    return 1;
+  }
+#endif
+  return std::max(requested, 1u);
+}
+
+larg4::OverlapCheckResult larg4::checkOverlaps(int points, double tolerance, unsigned nThreads)
+{
+  std::vector<G4VPhysicalVolume const*> placements;
+  for (G4VPhysicalVolume const* pv : *G4PhysicalVolumeStore::GetInstance()) {
+    if (dynamic_cast<G4PVPlacement const*>(pv) && pv->GetMotherLogical()) {
+      placements.push_back(pv);
+    }
+  }
+
+  OverlapCheckResult result;
+  result.points = points;
+  result.tolerance = tolerance;
+  result.placements = placements.size();
+  nThreads = overlapCheckThreads(nThreads);
+
+  // -- GetPointOnSurface() fills lazy caches of the solids (G4BooleanSolid,
+  //    G4Polycone...) and draws from the one random engine: the surfaces are
+  //    sampled serially, a batch of placements at a time, and the threads
+  //    only run the Inside() and distance queries, as tracking threads do
+  std::size_t const batchSize =
+    std::max<std::size_t>(maxBatchPoints / static_cast<std::size_t>(std::max(points, 1)), 1);
+  std::vector<std::vector<G4ThreeVector>> surfaces;
+  std::mutex resultMutex;
+  std::vector<Overlap> overlaps;
+  for (std::size_t first = 0; first < placements.size(); first += batchSize) {
+    std::size_t const n = std::min(batchSize, placements.size() - first);
+    surfaces.resize(n);
+    for (std::size_t i = 0; i < n; ++i) {
+      G4VSolid* solid = placements[first + i]->GetLogicalVolume()->GetSolid();
+      surfaces[i].clear();
+      for (int j = 0; j < points; ++j) {
+        surfaces[i].push_back(solid->GetPointOnSurface());
+      }
+    }
+
+    std::atomic<std::size_t> next{0};
+    auto worker = [&] {
+      std::vector<Overlap> found;
+      for (std::size_t i; (i = next++) < n;) {
+        auto const placement = checkPlacement(placements[first + i], surfaces[i], tolerance);
+        found.insert(found.end(), placement.begin(), placement.end());
+      }
+      std::lock_guard const lock{resultMutex};
+      overlaps.insert(overlaps.end(), found.begin(), found.end());
+    };
+    std::vector<std::thread> threads;
+    for (unsigned i = 1; i < nThreads; ++i) {
+      threads.emplace_back(worker);
+    }
+    worker();
+    for (auto& thread : threads) {
+      thread.join();
+    }
+  }
+  result.overlaps = describe(overlaps);
+  return result;
+}
+
+//-----------------------------------------------------------------------------
+std::string larg4::overlapResultFileName(std::string const& directory,
+                                         std::string const& gdmlFile,
+                                         std::uint64_t gdmlHash)
+{
+  std::ostringstream name;
+  name << directory << '/' << gdmlFile.substr(gdmlFile.find_last_of('/') + 1) << '.'
+       << std::hex << std::setw(16) << std::setfill('0') << gdmlHash << ".overlaps";
+  return name.str();
+}
+
+void larg4::writeOverlapResult(std::string const& fileName, OverlapCheckResult const& result)
+{
+  std::ofstream out{fileName};
+  out << "larg4-overlap-check " << resultFormatVersion << '\n'
+      << "hash " << std::hex << result.gdmlHash << std::dec << '\n'
+      << "points " << result.points << '\n'
+      << "tolerance " << result.tolerance << '\n'
+      << "placements " << result.placements << '\n'
+      << "overlaps " << result.overlaps.size() << '\n';
+  for (auto const& overlap : result.overlaps) {
+    out << overlap << '\n';
+  }
+  if (!out) {
+    throw cet::exception("OverlapCheck") << "Cannot write overlap check result " << fileName
+                                         << "\n";
+  }
+}
+
+std::optional<larg4::OverlapCheckResult> larg4::readOverlapResult(std::string const& fileName)
+{
+  std::ifstream in{fileName};
+  std::string key;
+  int version = 0;
+  if (!(in >> key >> version) || key != "larg4-overlap-check" || version != resultFormatVersion) {
+    return std::nullopt;
+  }
+  OverlapCheckResult result;
+  std::size_t nOverlaps = 0;
+  in >> key >> std::hex >> result.gdmlHash >> std::dec;
+  in >> key >> result.points >> key >> result.tolerance >> key >> result.placements;
+  in >> key >> nOverlaps >> std::ws;
+  for (std::string line; result.overlaps.size() < nOverlaps && std::getline(in, line);) {
+    result.overlaps.push_back(line);
+  }
+  if (!in || result.overlaps.size() != nOverlaps) return std::nullopt;
+  return result;
+}
@@ -0,0 +1,58 @@
+//=============================================================================
+// OverlapCheck.h:
+// Parallel overlap check of a Geant4 geometry and its result file.
+//
+// The check follows G4PVPlacement::CheckOverlaps(): points sampled on the
+// surface of each placed daughter must lie inside its mother and outside
+// all its siblings, within a tolerance.  The surface points are sampled
+// sequentially; the daughters are then checked concurrently when Geant4 is
+// built with multithreading, and sequentially otherwise.
+// The result is written by the larg4CheckOverlaps tool to a file keyed by
+// the content hash of the GDML file (see GeometryCache::contentHash), which
+// LArG4DetectorService reads to report the geometry as verified at startup.
+//=============================================================================
+
+#ifndef LARG4_SERVICES_OVERLAPCHECK_H
+#define LARG4_SERVICES_OVERLAPCHECK_H
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <vector>
+
+class G4VPhysicalVolume;
+
+namespace larg4 {
+
+  struct OverlapCheckResult {
+    std::uint64_t gdmlHash{};
+    int points{};                      ///< points sampled per placement
+    double tolerance{};                ///< [mm]
+    std::size_t placements{};          ///< number of placements checked
+    /// one description per protruding placement and per overlapping pair
+    std::vector<std::string> overlaps;
+  };
+
+  /// Number of threads checkOverlaps() runs on when asked for `requested`:
+  /// one without a multithreaded Geant4 build.
+  unsigned overlapCheckThreads(unsigned requested);
+
+  /// Checks all placements in the physical volume store with
+  /// overlapCheckThreads(nThreads) threads; the overlaps are sorted, so the
+  /// result does not depend on the scheduling.
+  OverlapCheckResult checkOverlaps(int points, double tolerance, unsigned nThreads);
+
+  /// Name of the result file for `gdmlFile` in `directory`.
+  std::string overlapResultFileName(std::string const& directory,
+                                    std::string const& gdmlFile,
+                                    std::uint64_t gdmlHash);
+
+  void writeOverlapResult(std::string const& fileName, OverlapCheckResult const& result);
+
+  /// Returns the result stored in `fileName`, if the file exists and is valid.
+  std::optional<OverlapCheckResult> readOverlapResult(std::string const& fileName);
+
+} // namespace larg4
+
+#endif // LARG4_SERVICES_OVERLAPCHECK_H
@@ -0,0 +1,102 @@
+//=============================================================================
+// RadiologicalLibrary.cc
+//=============================================================================
+
+#include "larg4/Services/RadiologicalLibrary.h"
+
+#include "cetlib_except/exception.h"
+
+#include <cstring>
+
+namespace {
+  constexpr char libraryMagic[8] = {'L', 'A', 'R', 'G', '4', 'R', 'A', 'D'};
+  constexpr std::uint32_t libraryVersion = 1;
+}
+
+larg4::RadiologicalLibrary::RadiologicalLibrary(std::string const& fileName) : file_{fileName}
+{
+  if (file_.size() < sizeof(Header)) {
+    throw cet::exception("RadiologicalLibrary")
+      << fileName << " is not a radiological library.\n";
+  }
+  auto const& header = *reinterpret_cast<Header const*>(file_.data());
+  if (std::memcmp(header.magic, libraryMagic, sizeof libraryMagic) != 0 ||
+      header.version != libraryVersion) {
+    throw cet::exception("RadiologicalLibrary")
+      << fileName << " is not a version " << libraryVersion << " radiological library.\n";
+  }
+  std::size_t const expected = sizeof(Header) + header.nIsotopes * sizeof(Isotope) +
+                               header.nDecays * sizeof(Decay) +
+                               header.nDeposits * sizeof(Deposit);
+  if (file_.size() != expected) {
+    throw cet::exception("RadiologicalLibrary")
+      << fileName << " has " << file_.size() << " bytes, " << expected << " expected.\n";
+  }
+  char const* p = file_.data() + sizeof(Header);
+  nIsotopes_ = header.nIsotopes;
+  isotopes_ = reinterpret_cast<Isotope const*>(p);
+  p += header.nIsotopes * sizeof(Isotope);
+  decays_ = reinterpret_cast<Decay const*>(p);
+  p += header.nDecays * sizeof(Decay);
+  deposits_ = reinterpret_cast<Deposit const*>(p);
+
+  // -- the indices are checked once here, not for every decay overlaid
+  for (std::uint32_t i = 0; i < nIsotopes_; ++i) {
+    if (isotopes_[i].firstDecay + isotopes_[i].nDecays > header.nDecays ||
+        std::memchr(isotopes_[i].name, '\0', sizeof isotopes_[i].name) == nullptr) {
+      throw cet::exception("RadiologicalLibrary") << fileName << " has invalid isotopes.\n";
+    }
+  }
+  for (std::uint64_t i = 0; i < header.nDecays; ++i) {
+    if (decays_[i].firstDeposit + decays_[i].nDeposits > header.nDeposits) {
+      throw cet::exception("RadiologicalLibrary") << fileName << " has invalid decays.\n";
+    }
+  }
+}
+
+larg4::RadiologicalLibrary::Isotope const& larg4::RadiologicalLibrary::isotope(
+  std::string const& name) const
+{
+  for (std::uint32_t i = 0; i < nIsotopes_; ++i) {
+    if (name == isotopes_[i].name && isotopes_[i].nDecays > 0) return isotopes_[i];
+  }
+  throw cet::exception("RadiologicalLibrary")
+    << "No decays of " << name << " in " << fileName() << ".\n";
+}
+
+void larg4::RadiologicalLibrary::write(std::string const& fileName, Content const& content)
+{
+  Header header{};
+  std::memcpy(header.magic, libraryMagic, sizeof libraryMagic);
+  header.version = libraryVersion;
+  std::vector<Isotope> isotopes;
+  std::vector<Decay> decays;
+  std::vector<Deposit> deposits;
+  for (auto const& [name, isotopeDecays] : content) {
+    Isotope isotope{};
+    if (name.size() >= sizeof isotope.name) {
+      throw cet::exception("RadiologicalLibrary") << "Isotope name too long: " << name << "\n";
+    }
+    std::strncpy(isotope.name, name.c_str(), sizeof isotope.name);
+    isotope.nDecays = isotopeDecays.size();
+    isotope.firstDecay = decays.size();
+    isotopes.push_back(isotope);
+    for (auto const& decayDeposits : isotopeDecays) {
+      float energy = 0.f;
+      for (auto const& deposit : decayDeposits) {
+        energy += deposit.edep;
+      }
+      decays.push_back({deposits.size(), static_cast<std::uint32_t>(decayDeposits.size()), energy});
+      deposits.insert(deposits.end(), decayDeposits.begin(), decayDeposits.end());
+    }
+  }
+  header.nIsotopes = isotopes.size();
+  header.nDecays = decays.size();
+  header.nDeposits = deposits.size();
+
+  writeFileAtomically(fileName,
+                      {{reinterpret_cast<char const*>(&header), sizeof header},
+                       bytesOf(isotopes),
+                       bytesOf(decays),
+                       bytesOf(deposits)});
+}
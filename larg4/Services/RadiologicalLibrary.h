@@ -0,0 +1,99 @@
+//=============================================================================
+// RadiologicalLibrary.h:
+// Library of simulated radioactive decays, written by the
+// RadiologicalLibraryMaker module and overlaid on events by
+// RadiologicalOverlay in place of simulating the decays with Geant4.
+//
+// Each decay is stored as the energy deposits it produced, with positions
+// and times relative to the decay vertex.  Decays which deposited nothing
+// are kept, so that picking decays uniformly follows the activity.  The
+// library file is memory-mapped; its layout (native byte order, 8-byte
+// aligned sections) is:
+//   Header, Isotope[nIsotopes], Decay[nDecays], Deposit[nDeposits]
+// with the indices of the first decay and deposit referring to the whole
+// file.
+//=============================================================================
+
+#ifndef LARG4_SERVICES_RADIOLOGICALLIBRARY_H
+#define LARG4_SERVICES_RADIOLOGICALLIBRARY_H
+
+#include "larg4/Services/MappedFile.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <string>
+#include <vector>
+
+namespace larg4 {
+
+  class RadiologicalLibrary {
+  public:
+    // -- file layout
+    struct Header {
+      char magic[8]; ///< "LARG4RAD"
+      std::uint32_t version;
+      std::uint32_t nIsotopes;
+      std::uint64_t nDecays;
+      std::uint64_t nDeposits;
+    };
+    struct Isotope {
+      char name[24]; ///< null-terminated
+      std::uint32_t nDecays;
+      std::uint32_t padding;
+      std::uint64_t firstDecay;
+    };
+    struct Decay {
+      std::uint64_t firstDeposit;
+      std::uint32_t nDeposits;
+      float energy; ///< total deposited energy [MeV]
+    };
+    struct Deposit {
+      float start[3]; ///< relative to the vertex [cm]
+      float end[3];   ///< relative to the vertex [cm]
+      float startT;   ///< relative to the decay [ns]
+      float endT;     ///< relative to the decay [ns]
+      float edep;     ///< [MeV]
+      float scintYieldRatio;
+      std::int32_t numPhotons;
+      std::int32_t numElectrons;
+      std::int32_t pdg;
+    };
+
+    struct DecayView {
+      Deposit const* begin;
+      Deposit const* end;
+    };
+
+    /// Decays to write, by isotope name.
+    using Content = std::map<std::string, std::vector<std::vector<Deposit>>>;
+
+    /// Maps and validates `fileName`; throws cet::exception on a bad file.
+    explicit RadiologicalLibrary(std::string const& fileName);
+
+    std::string const& fileName() const { return file_.fileName(); }
+
+    /// The decays of `isotope`; throws cet::exception if it has none.
+    Isotope const& isotope(std::string const& name) const;
+
+    DecayView decay(Isotope const& isotope, std::size_t i) const
+    {
+      Decay const& decay = decays_[isotope.firstDecay + i];
+      Deposit const* first = deposits_ + decay.firstDeposit;
+      return {first, first + decay.nDeposits};
+    }
+
+    /// Writes `content` to `fileName`.
+    static void write(std::string const& fileName, Content const& content);
+
+  private:
+    MappedFile file_;
+    Isotope const* isotopes_{nullptr};
+    std::uint32_t nIsotopes_{0};
+    Decay const* decays_{nullptr};
+    Deposit const* deposits_{nullptr};
+  };
+
+} // namespace larg4
+
+#endif // LARG4_SERVICES_RADIOLOGICALLIBRARY_H
@@ -13,26 +13,47 @@
 // Author: Hans Wenzel (Fermilab)
 //=============================================================================
 #include "larg4/Services/SimEnergyDepositSD.h"
+#include "Geant4/G4Alpha.hh"
 #include "Geant4/G4Cerenkov.hh"
+#include "Geant4/G4Deuteron.hh"
 #include "Geant4/G4Event.hh"
 #include "Geant4/G4EventManager.hh"
+#include "Geant4/G4FastTrack.hh"
+#include "Geant4/G4GFlashSpot.hh"
 #include "Geant4/G4HCofThisEvent.hh"
+#include "Geant4/G4IonisParamMat.hh"
+#include "Geant4/G4LogicalVolume.hh"
+#include "Geant4/G4Material.hh"
+#include "Geant4/G4MaterialPropertiesTable.hh"
+#include "Geant4/G4Poisson.hh"
+#include "Geant4/G4Proton.hh"
 #include "Geant4/G4SDManager.hh"
 #include "Geant4/G4Scintillation.hh"
 #include "Geant4/G4Step.hh"
 #include "Geant4/G4SteppingManager.hh"
 #include "Geant4/G4ThreeVector.hh"
+#include "Geant4/G4Triton.hh"
+#include "Geant4/G4VPhysicalVolume.hh"
+#include "Geant4/G4VProcess.hh"
 #include "Geant4/G4VSolid.hh"
 #include "Geant4/G4VVisManager.hh"
 #include "Geant4/G4ios.hh"
+#include "Geant4/Randomize.hh"
+
+#include "cetlib_except/exception.h"
+
+#include <algorithm>
+#include <cmath>
+#include <sstream>
 
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
 namespace larg4 {
 
-  SimEnergyDepositSD::SimEnergyDepositSD(G4String name) : G4VSensitiveDetector(name)
-  {
-    hitCollection.clear();
-  }
+  SimEnergyDepositSD::SimEnergyDepositSD(G4String name,
+                                         std::size_t arenaChunkSize,
+                                         std::size_t arenaHistory)
+    : G4VSensitiveDetector(name), hitCollection(arenaChunkSize, arenaHistory)
+  {}
 
   //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
 
@@ -42,19 +63,12 @@ namespace larg4 {
 
   void SimEnergyDepositSD::Initialize(G4HCofThisEvent* HCE)
   {
-    hitCollection.clear();
+    hitCollection.reset();
   }
   //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
 
-  G4bool SimEnergyDepositSD::ProcessHits(G4Step* aStep, G4TouchableHistory*)
+  G4int ScintillationProcessPhotons::photons(G4Step const&)
   {
-    G4double edep = aStep->GetTotalEnergyDeposit() / CLHEP::MeV;
-
-    if (edep == 0.) return false;
-    //std::cout << "7777777777777777:   "<< aStep->GetTotalEnergyDeposit()/CLHEP::MeV << "   " << aStep->GetTotalEnergyDeposit() <<std::endl;
-    const int electronsperMeV = 10000;
-    int nrelec = (int)round(edep * electronsperMeV);
-    if (aStep->GetTrack()->GetDynamicParticle()->GetCharge() == 0) return false;
     G4int photons = 0;
     G4SteppingManager* fpSteppingManager =
       G4EventManager::GetEventManager()->GetTrackingManager()->GetSteppingManager();
@@ -65,37 +79,260 @@ namespace larg4 {
       for (size_t i3 = 0; i3 < MAXofPostStepLoops; i3++) {
         if (!(*procPost)[i3]) continue;
         /*
-             if ((*procPost)[i3]->GetProcessName() == "Cerenkov") {
-             G4Cerenkov* proc =(G4Cerenkov*) (*procPost)[i3];
-             photons+=proc->GetNumPhotons();
-             }
-           */
+           if ((*procPost)[i3]->GetProcessName() == "Cerenkov") {
+           G4Cerenkov* proc =(G4Cerenkov*) (*procPost)[i3];
+           photons+=proc->GetNumPhotons();
+           }
+         */
         if ((*procPost)[i3]->GetProcessName() == "Scintillation") {
           G4Scintillation* proc1 = (G4Scintillation*)(*procPost)[i3];
           photons += proc1->GetNumPhotons();
         }
       }
     }
-    geo::Point_t start = geo::Point_t(aStep->GetPreStepPoint()->GetPosition().x() / CLHEP::cm,
-                                      aStep->GetPreStepPoint()->GetPosition().y() / CLHEP::cm,
-                                      aStep->GetPreStepPoint()->GetPosition().z() / CLHEP::cm);
-    geo::Point_t end = geo::Point_t(aStep->GetPostStepPoint()->GetPosition().x() / CLHEP::cm,
-                                    aStep->GetPostStepPoint()->GetPosition().y() / CLHEP::cm,
-                                    aStep->GetPostStepPoint()->GetPosition().z() / CLHEP::cm);
-    sim::SimEnergyDeposit newHit =
-      sim::SimEnergyDeposit(photons,
-                            nrelec,
-                            1.0,
-                            edep,
-                            start,
-                            end,
-                            aStep->GetPreStepPoint()->GetGlobalTime() / CLHEP::ns,
-                            aStep->GetPostStepPoint()->GetGlobalTime() / CLHEP::ns,
-                            aStep->GetTrack()->GetTrackID(),
-                            aStep->GetTrack()->GetParticleDefinition()->GetPDGEncoding(),
-                            aStep->GetTrack()->GetTrackID() //original track id
-      );
-    hitCollection.push_back(newHit);
+    return photons;
+  }
+
+  //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+  AnalyticPhotonYield::MaterialYield AnalyticPhotonYield::readYield(G4Material const& material)
+  {
+    MaterialYield yield;
+    yield.birks = material.GetIonisation()->GetBirksConstant();
+    G4MaterialPropertiesTable* table = material.GetMaterialPropertiesTable();
+    if (!table) return yield;
+    if (table->ConstPropertyExists("SCINTILLATIONYIELD")) {
+      yield.yield = table->GetConstProperty("SCINTILLATIONYIELD");
+    }
+    if (table->ConstPropertyExists("RESOLUTIONSCALE")) {
+      yield.resolution = table->GetConstProperty("RESOLUTIONSCALE");
+    }
+    yield.electron = table->GetProperty("ELECTRONSCINTILLATIONYIELD");
+    yield.proton = table->GetProperty("PROTONSCINTILLATIONYIELD");
+    yield.deuteron = table->GetProperty("DEUTERONSCINTILLATIONYIELD");
+    yield.triton = table->GetProperty("TRITONSCINTILLATIONYIELD");
+    yield.alpha = table->GetProperty("ALPHASCINTILLATIONYIELD");
+    yield.ion = table->GetProperty("IONSCINTILLATIONYIELD");
+    return yield;
+  }
+
+  G4double AnalyticPhotonYield::meanPhotons(G4Step const& step, MaterialYield const& yield) const
+  {
+    G4double const edep = step.GetTotalEnergyDeposit();
+    G4ParticleDefinition const* particle = step.GetTrack()->GetParticleDefinition();
+
+    // -- the yield by particle type follows the choice of G4Scintillation
+    G4MaterialPropertyVector const* byType = yield.electron;
+    if (particle == G4Proton::Definition()) { byType = yield.proton; }
+    else if (particle == G4Deuteron::Definition()) {
+      byType = yield.deuteron;
+    }
+    else if (particle == G4Triton::Definition()) {
+      byType = yield.triton;
+    }
+    else if (particle == G4Alpha::Definition()) {
+      byType = yield.alpha;
+    }
+    else if (particle->GetParticleType() == "nucleus") {
+      byType = yield.ion;
+    }
+    if (byType) {
+      // -- the tabulated yield is cumulative in kinetic energy: its mean
+      //    slope over the step applies to the energy deposited in the step
+      G4double const preEnergy = step.GetPreStepPoint()->GetKineticEnergy();
+      G4double const postEnergy = step.GetPostStepPoint()->GetKineticEnergy();
+      if (preEnergy > postEnergy) {
+        G4double const photons = byType->Value(preEnergy) - byType->Value(postEnergy);
+        return std::max(photons, 0.) * edep / (preEnergy - postEnergy);
+      }
+      return preEnergy > 0. ? byType->Value(preEnergy) / preEnergy * edep : 0.;
+    }
+
+    // -- Birks quenching of the energy deposited along the step
+    G4double const length = step.GetStepLength();
+    G4double visible = edep;
+    if (yield.birks > 0. && length > 0.) { visible = edep / (1. + yield.birks * edep / length); }
+    return yield.yield * visible;
+  }
+
+  AnalyticPhotonYield::MaterialYield const& AnalyticPhotonYield::yieldOf(
+    G4Material const* material)
+  {
+    if (material != fLastMaterial) {
+      auto it = fYields.find(material);
+      if (it == fYields.end()) { it = fYields.emplace(material, readYield(*material)).first; }
+      fLastMaterial = material;
+      fLastYield = &it->second;
+    }
+    return *fLastYield;
+  }
+
+  G4int AnalyticPhotonYield::fluctuate(G4double mean, MaterialYield const& yield)
+  {
+    if (mean <= 0.) return 0;
+    if (mean <= 10.) return G4Poisson(mean);
+    G4double const sigma = yield.resolution * std::sqrt(mean);
+    return std::max(0, static_cast<G4int>(std::lround(G4RandGauss::shoot(mean, sigma))));
+  }
+
+  G4int AnalyticPhotonYield::photons(G4Step const& step)
+  {
+    MaterialYield const& yield = yieldOf(step.GetPreStepPoint()->GetMaterial());
+    return fluctuate(meanPhotons(step, yield), yield);
+  }
+
+  G4int AnalyticPhotonYield::photons(G4double edep, G4Material const& material)
+  {
+    MaterialYield const& yield = yieldOf(&material);
+    G4double mean = yield.yield * edep;
+    if (yield.electron) {
+      // -- shower electrons are minimum ionizing: the asymptotic electron yield
+      G4double const energy = yield.electron->GetMaxEnergy();
+      if (energy > 0.) { mean = yield.electron->Value(energy) / energy * edep; }
+    }
+    return fluctuate(mean, yield);
+  }
+
+  //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+  template <typename PhotonYield, typename ElectronYield>
+  G4bool SimEnergyDepositSDT<PhotonYield, ElectronYield>::ProcessHits(
+    G4Step* aStep,
+    G4TouchableHistory*)
+  {
+    G4double edep = aStep->GetTotalEnergyDeposit() / CLHEP::MeV;
+
+    if (edep == 0.) return false;
+    if (!this->recordsDeposits()) return false;
+    if (aStep->GetTrack()->GetDynamicParticle()->GetCharge() == 0) return false;
+    // -- the energy of a fast-simulation step reaches the detector as spots
+    G4VProcess const* process = aStep->GetPostStepPoint()->GetProcessDefinedStep();
+    if (process && process->GetProcessType() == fParameterisation) return false;
+    int nrelec = ElectronYield::electrons(edep);
+    G4int photons = photonYield.photons(*aStep);
+    G4StepPoint const* pre = aStep->GetPreStepPoint();
+    G4StepPoint const* post = aStep->GetPostStepPoint();
+    G4ThreeVector const& prePos = pre->GetPosition();
+    G4ThreeVector const& postPos = post->GetPosition();
+    G4Track const* track = aStep->GetTrack();
+    int const trackID = track->GetTrackID();
+    hitCollection.emplace_back(
+      photons,
+      nrelec,
+      1.0,
+      edep,
+      geo::Point_t{prePos.x() / CLHEP::cm, prePos.y() / CLHEP::cm, prePos.z() / CLHEP::cm},
+      geo::Point_t{postPos.x() / CLHEP::cm, postPos.y() / CLHEP::cm, postPos.z() / CLHEP::cm},
+      pre->GetGlobalTime() / CLHEP::ns,
+      post->GetGlobalTime() / CLHEP::ns,
+      trackID,
+      track->GetParticleDefinition()->GetPDGEncoding(),
+      trackID //original track id
+    );
     return true;
   } // end ProcessHits
+
+  template <typename PhotonYield, typename ElectronYield>
+  G4bool SimEnergyDepositSDT<PhotonYield, ElectronYield>::ProcessHits(
+    G4GFlashSpot* aSpot,
+    G4TouchableHistory*)
+  {
+    G4double edep = aSpot->GetEnergySpot()->GetEnergy() / CLHEP::MeV;
+    if (edep <= 0.) return false;
+    if (!this->recordsDeposits()) return false;
+    G4Material const& material =
+      *aSpot->GetTouchableHandle()->GetVolume()->GetLogicalVolume()->GetMaterial();
+    int nrelec = ElectronYield::electrons(edep);
+    G4int photons = photonYield.photons(edep * CLHEP::MeV, material);
+    // -- the spot is a point deposit of the particle which started the shower
+    G4Track const* track = aSpot->GetOriginatorTrack()->GetPrimaryTrack();
+    G4ThreeVector const& pos = aSpot->GetEnergySpot()->GetPosition();
+    geo::Point_t const point{pos.x() / CLHEP::cm, pos.y() / CLHEP::cm, pos.z() / CLHEP::cm};
+    double const time = track->GetGlobalTime() / CLHEP::ns;
+    int const trackID = track->GetTrackID();
+    hitCollection.emplace_back(photons,
+                               nrelec,
+                               1.0,
+                               edep,
+                               point,
+                               point,
+                               time,
+                               time,
+                               trackID,
+                               track->GetParticleDefinition()->GetPDGEncoding(),
+                               trackID);
+    return true;
+  }
+
+  //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+  void SimEnergyDepositSDOptions::apply(std::string const& option)
+  {
+    if (option == "noPhotons") { countPhotons = false; }
+    else if (option == "computePhotonsAnalytically") {
+      computePhotonsAnalytically = true;
+    }
+    else if (option == "noElectrons") {
+      countElectrons = false;
+    }
+    else {
+      throw cet::exception("SimEnergyDepositSD")
+        << "Unknown SimEnergyDeposit option: \"" << option << "\".\n"
+        << "Valid options are: noPhotons, computePhotonsAnalytically, noElectrons.\n";
+    }
+  }
+
+  void SimEnergyDepositSDOptions::apply(std::vector<std::string> const& options)
+  {
+    for (auto const& option : options) {
+      apply(option);
+    }
+  }
+
+  //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+  std::string splitSensDetValue(std::string const& value, std::vector<std::string>& options)
+  {
+    options.clear();
+    std::istringstream ss{value};
+    std::string type;
+    std::getline(ss, type, ':');
+    for (std::string option; std::getline(ss, option, ':');) {
+      if (!option.empty()) options.push_back(option);
+    }
+    return type;
+  }
+
+  //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+  namespace {
+    template <typename PhotonYield>
+    SimEnergyDepositSD* makeWithPhotons(G4String const& name,
+                                        SimEnergyDepositSDOptions const& options,
+                                        std::size_t arenaChunkSize,
+                                        std::size_t arenaHistory)
+    {
+      if (options.countElectrons) {
+        return new SimEnergyDepositSDT<PhotonYield, FixedElectronYield>(
+          name, arenaChunkSize, arenaHistory);
+      }
+      return new SimEnergyDepositSDT<PhotonYield, NoElectronYield>(
+        name, arenaChunkSize, arenaHistory);
+    }
+  }
+
+  SimEnergyDepositSD* makeSimEnergyDepositSD(G4String name,
+                                             SimEnergyDepositSDOptions const& options,
+                                             std::size_t arenaChunkSize,
+                                             std::size_t arenaHistory)
+  {
+    if (!options.countPhotons) {
+      return makeWithPhotons<NoPhotonYield>(name, options, arenaChunkSize, arenaHistory);
+    }
+    if (options.computePhotonsAnalytically) {
+      return makeWithPhotons<AnalyticPhotonYield>(name, options, arenaChunkSize, arenaHistory);
+    }
+    return makeWithPhotons<ScintillationProcessPhotons>(
+      name, options, arenaChunkSize, arenaHistory);
+  }
 } // end namespace  larg4
@@ -2,33 +2,169 @@
 //=============================================================================
 // SimEnergyDepositSD: Class representing a liquid Ar TPC
 // Author: Hans Wenzel (Fermilab)
+//
+// The step processing is specialized at compile time on:
+//  - the source of the number of scintillation photons: the Scintillation
+//    process of the step, the material yield ("computePhotonsAnalytically"),
+//    or none,
+//  - the model for the number of ionization electrons.
+// The variant is chosen from the value of the SensDet auxiliary tag, e.g.
+// "SimEnergyDeposit:noPhotons", see makeSimEnergyDepositSD().
+//
+// The detector also records the energy spots of parameterized (GFlash)
+// showers, as point-like deposits of the track that started the shower.
 //=============================================================================
 
 #ifndef LARG4_SERVICES_SIMENERGYDEPOSITSD_H
 #define LARG4_SERVICES_SIMENERGYDEPOSITSD_H
+#include "Geant4/G4VGFlashSensitiveDetector.hh"
 #include "Geant4/G4VSensitiveDetector.hh"
 #include "lardataobj/Simulation/SimEnergyDeposit.h"
+#include "larg4/Services/HitArena.h"
+#include "larg4/pluginActions/GeneratorPolicy.h"
+
+#include <cmath>
+#include <cstddef>
+#include <string>
+#include <unordered_map>
+#include <vector>
 
+class G4GFlashSpot;
 class G4Step;
 class G4HCofThisEvent;
+class G4Material;
+class G4MaterialPropertyVector;
 //class SimEnergyDepositCollection;
 
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
 namespace larg4 {
 
-  class SimEnergyDepositSD : public G4VSensitiveDetector {
+  class SimEnergyDepositSD : public G4VSensitiveDetector, public G4VGFlashSensitiveDetector {
   public:
-    SimEnergyDepositSD(G4String);
+    SimEnergyDepositSD(G4String, std::size_t arenaChunkSize = 4096, std::size_t arenaHistory = 8);
     ~SimEnergyDepositSD();
     void Initialize(G4HCofThisEvent*);
-    G4bool ProcessHits(G4Step*, G4TouchableHistory*);
-    const sim::SimEnergyDepositCollection& GetHits() const { return hitCollection; }
+    sim::SimEnergyDepositCollection GetHits() const
+    {
+      return hitCollection.to_collection<sim::SimEnergyDepositCollection>();
+    }
+
+    /// Deposits are recorded only while the policy `current` points to, the
+    /// one of the generator of the tracked particle, asks for them (all if
+    /// not set).
+    void SetGeneratorPolicy(GeneratorPolicy const* current) { generatorPolicy = current; }
+
+  protected:
+    bool recordsDeposits() const
+    {
+      return !generatorPolicy || generatorPolicy->simEnergyDeposits;
+    }
+
+    HitArena<sim::SimEnergyDeposit> hitCollection;
+    GeneratorPolicy const* generatorPolicy{nullptr};
+  };
+
+  //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+  // Electron yield models
+
+  /// Fixed number of ionization electrons per MeV of deposited energy.
+  struct FixedElectronYield {
+    static constexpr int electronsperMeV = 10000;
+    static int electrons(G4double edepMeV) { return (int)std::round(edepMeV * electronsperMeV); }
+  };
+
+  /// No ionization electrons are computed (left to the downstream detector simulation).
+  struct NoElectronYield {
+    static int electrons(G4double) { return 0; }
+  };
+
+  //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+  // Photon yield models
+
+  /// Number of photons generated by the Scintillation process in the step.
+  struct ScintillationProcessPhotons {
+    G4int photons(G4Step const& step);
+    /// The process does not run in parameterized showers.
+    G4int photons(G4double, G4Material const&) { return 0; }
+  };
+
+  /// Mean number of scintillation photons from the yield properties of the
+  /// material, with Poisson/Gaussian fluctuations as in G4Scintillation, so
+  /// that the Scintillation process need not run.  Materials providing a yield
+  /// by particle type (ELECTRONSCINTILLATIONYIELD, PROTON..., DEUTERON...,
+  /// TRITON..., ALPHA..., ION...) use it; otherwise SCINTILLATIONYIELD applies
+  /// to the visible energy after Birks quenching with the Birks constant of
+  /// the material.  Energy spots of parameterized showers use the electron
+  /// yield without quenching.
+  class AnalyticPhotonYield {
+  public:
+    G4int photons(G4Step const& step);
+    G4int photons(G4double edep, G4Material const& material);
 
   private:
-    sim::SimEnergyDepositCollection hitCollection;
+    struct MaterialYield {
+      G4double yield{0.};      ///< SCINTILLATIONYIELD [1/energy]
+      G4double resolution{1.}; ///< RESOLUTIONSCALE
+      G4double birks{0.};      ///< Birks constant [length/energy]
+      G4MaterialPropertyVector const* electron{nullptr};
+      G4MaterialPropertyVector const* proton{nullptr};
+      G4MaterialPropertyVector const* deuteron{nullptr};
+      G4MaterialPropertyVector const* triton{nullptr};
+      G4MaterialPropertyVector const* alpha{nullptr};
+      G4MaterialPropertyVector const* ion{nullptr};
+    };
+    static MaterialYield readYield(G4Material const& material);
+    MaterialYield const& yieldOf(G4Material const* material);
+    G4double meanPhotons(G4Step const& step, MaterialYield const& yield) const;
+    static G4int fluctuate(G4double mean, MaterialYield const& yield);
+
+    std::unordered_map<G4Material const*, MaterialYield> fYields;
+    G4Material const* fLastMaterial{nullptr};
+    MaterialYield const* fLastYield{nullptr};
+  };
+
+  /// No scintillation photons are counted.
+  struct NoPhotonYield {
+    G4int photons(G4Step const&) { return 0; }
+    G4int photons(G4double, G4Material const&) { return 0; }
   };
 
   //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+  template <typename PhotonYield, typename ElectronYield>
+  class SimEnergyDepositSDT final : public SimEnergyDepositSD {
+  public:
+    using SimEnergyDepositSD::SimEnergyDepositSD;
+    G4bool ProcessHits(G4Step*, G4TouchableHistory*) override;
+    G4bool ProcessHits(G4GFlashSpot*, G4TouchableHistory*) override;
+
+  private:
+    PhotonYield photonYield;
+  };
+
+  //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+  struct SimEnergyDepositSDOptions {
+    bool countPhotons{true};   ///< look up the number of scintillation photons ("noPhotons")
+    bool computePhotonsAnalytically{false}; ///< from the material ("computePhotonsAnalytically")
+    bool countElectrons{true}; ///< compute the number of electrons ("noElectrons")
+
+    /// Applies options in the form "noPhotons", "computePhotonsAnalytically",
+    /// "noElectrons"; throws on unknown options.  "noPhotons" takes precedence
+    /// over "computePhotonsAnalytically".
+    void apply(std::string const& option);
+    void apply(std::vector<std::string> const& options);
+  };
+
+  /// Splits a SensDet value "SimEnergyDeposit[:option[:option...]]" into the
+  /// detector type and its options.
+  std::string splitSensDetValue(std::string const& value, std::vector<std::string>& options);
+
+  /// Creates the specialization matching the requested options.
+  SimEnergyDepositSD* makeSimEnergyDepositSD(G4String name,
+                                             SimEnergyDepositSDOptions const& options,
+                                             std::size_t arenaChunkSize = 4096,
+                                             std::size_t arenaHistory = 8);
 }
 
 #endif //  LARG4_SERVICES_SIMENERGYDEPOSITSD_H
@@ -0,0 +1,520 @@
+//=============================================================================
+// TGeoToG4.cc: conversion of the ROOT TGeo geometry into Geant4 volumes
+//
+// TGeo placements and boolean operands carry local-to-mother transformations
+// (master = R * local + T), which is what G4Transform3D expects, so matrices
+// are copied over as they are.  Quantities are converted from ROOT units (cm,
+// g/cm3, g/mole, GeV, s); a geometry loaded with Geant4 units is refused.
+//=============================================================================
+
+#include "larg4/Services/TGeoToG4.h"
+#include "larg4/Services/GeometryCache.h"
+
+#include "cetlib_except/exception.h"
+#include "messagefacility/MessageLogger/MessageLogger.h"
+
+#include "Geant4/G4Box.hh"
+#include "Geant4/G4Cons.hh"
+#include "Geant4/G4DisplacedSolid.hh"
+#include "Geant4/G4Element.hh"
+#include "Geant4/G4IntersectionSolid.hh"
+#include "Geant4/G4Isotope.hh"
+#include "Geant4/G4LogicalBorderSurface.hh"
+#include "Geant4/G4LogicalSkinSurface.hh"
+#include "Geant4/G4LogicalVolume.hh"
+#include "Geant4/G4Material.hh"
+#include "Geant4/G4MaterialPropertiesTable.hh"
+#include "Geant4/G4NistManager.hh"
+#include "Geant4/G4OpticalSurface.hh"
+#include "Geant4/G4PVPlacement.hh"
+#include "Geant4/G4Polycone.hh"
+#include "Geant4/G4Polyhedra.hh"
+#include "Geant4/G4RotationMatrix.hh"
+#include "Geant4/G4Sphere.hh"
+#include "Geant4/G4SubtractionSolid.hh"
+#include "Geant4/G4SystemOfUnits.hh"
+#include "Geant4/G4ThreeVector.hh"
+#include "Geant4/G4Transform3D.hh"
+#include "Geant4/G4Trd.hh"
+#include "Geant4/G4Tubs.hh"
+#include "Geant4/G4UnionSolid.hh"
+
+#include "TGDMLMatrix.h"
+#include "TGeoBBox.h"
+#include "TGeoBoolNode.h"
+#include "TGeoCompositeShape.h"
+#include "TGeoCone.h"
+#include "TGeoElement.h"
+#include "TGeoManager.h"
+#include "TGeoMaterial.h"
+#include "TGeoMatrix.h"
+#include "TGeoNode.h"
+#include "TGeoOpticalSurface.h"
+#include "TGeoPcon.h"
+#include "TGeoPgon.h"
+#include "TGeoSphere.h"
+#include "TGeoTrd1.h"
+#include "TGeoTrd2.h"
+#include "TGeoTube.h"
+#include "TGeoVolume.h"
+#include "TList.h"
+#include "TNamed.h"
+#include "TObjArray.h"
+
+#include <cctype>
+#include <vector>
+
+namespace {
+
+  G4Transform3D transform(TGeoMatrix const* matrix, double lengthUnit)
+  {
+    if (!matrix) return G4Transform3D{};
+    Double_t const* r = matrix->GetRotationMatrix();
+    Double_t const* t = matrix->GetTranslation();
+    CLHEP::HepRep3x3 const rep{r[0], r[1], r[2], r[3], r[4], r[5], r[6], r[7], r[8]};
+    return G4Transform3D{G4RotationMatrix{rep},
+                         G4ThreeVector{t[0], t[1], t[2]} * lengthUnit};
+  }
+
+  //---------------------------------------------------------------------------
+  // Units of the values of the material and surface properties; everything
+  // not listed is dimensionless.
+  enum class PropertyUnit { None, Length, Time, PerEnergy };
+
+  PropertyUnit propertyUnit(std::string const& name)
+  {
+    if (name == "ABSLENGTH" || name == "RAYLEIGH" || name == "WLSABSLENGTH" || name == "MIEHG")
+      return PropertyUnit::Length;
+    if (name.find("TIMECONSTANT") != std::string::npos ||
+        name.find("RISETIME") != std::string::npos)
+      return PropertyUnit::Time;
+    // -- only the constant yield is per energy; the per-particle yields
+    // (PROTONSCINTILLATIONYIELD...) are tables of values that stay as they are
+    if (name == "SCINTILLATIONYIELD") return PropertyUnit::PerEnergy;
+    return PropertyUnit::None;
+  }
+
+  //---------------------------------------------------------------------------
+  // The shape if it is of class T itself, not of a class derived from it
+  // (TGeoCtub derives from TGeoTubeSeg, TGeoEltu from TGeoTube...).
+  template <typename T>
+  T const* exactly(TGeoShape const* shape)
+  {
+    return shape->IsA() == T::Class() ? static_cast<T const*>(shape) : nullptr;
+  }
+
+  //---------------------------------------------------------------------------
+  // Minimal reading of the GDML <auxiliary> elements.
+  std::string attribute(std::string const& tag, std::string const& name)
+  {
+    auto isSpace = [](char c) { return std::isspace(static_cast<unsigned char>(c)) != 0; };
+    for (auto pos = tag.find(name); pos != std::string::npos; pos = tag.find(name, pos + 1)) {
+      // -- the name must be a whole attribute name: after white space, before '='
+      if (pos == 0 || !isSpace(tag[pos - 1])) continue;
+      auto value = pos + name.size();
+      while (value < tag.size() && isSpace(tag[value]))
+        ++value;
+      if (value == tag.size() || tag[value] != '=') continue;
+      do
+        ++value;
+      while (value < tag.size() && isSpace(tag[value]));
+      if (value == tag.size() || (tag[value] != '"' && tag[value] != '\'')) return {};
+      auto const end = tag.find(tag[value], value + 1);
+      if (end == std::string::npos) return {};
+      return tag.substr(value + 1, end - value - 1);
+    }
+    return {};
+  }
+
+  // Reads the <auxiliary> element starting at `pos` (and the ones nested in
+  // it, which go into `storage`) into `list`; returns the position after it.
+  std::size_t readAuxiliary(std::string const& text,
+                            std::size_t pos,
+                            G4GDMLAuxListType& list,
+                            std::deque<G4GDMLAuxListType>& storage)
+  {
+    auto const tagEnd = text.find('>', pos);
+    if (tagEnd == std::string::npos) {
+      throw cet::exception("TGeoToG4") << "Unterminated <auxiliary> element.\n";
+    }
+    std::string const tag = text.substr(pos, tagEnd - pos);
+    G4GDMLAuxStructType aux;
+    aux.type = attribute(tag, "auxtype");
+    aux.value = attribute(tag, "auxvalue");
+    aux.unit = attribute(tag, "auxunit");
+    aux.auxList = nullptr;
+    pos = tagEnd + 1;
+    if (tag.back() != '/') {
+      aux.auxList = &storage.emplace_back();
+      for (;;) {
+        auto const next = text.find('<', pos);
+        if (next == std::string::npos) {
+          throw cet::exception("TGeoToG4") << "Unterminated <auxiliary> element.\n";
+        }
+        if (text.compare(next, 12, "</auxiliary>") == 0) {
+          pos = next + 12;
+          break;
+        }
+        if (text.compare(next, 10, "<auxiliary") == 0)
+          pos = readAuxiliary(text, next, *aux.auxList, storage);
+        else
+          pos = text.find('>', next) + 1;
+      }
+    }
+    list.push_back(aux);
+    return pos;
+  }
+
+} // namespace
+
+//-----------------------------------------------------------------------------
+G4VPhysicalVolume* larg4::TGeoToG4::convert(TGeoManager& geoManager)
+{
+  if (TGeoManager::GetDefaultUnits() != TGeoManager::kRootUnits) {
+    throw cet::exception("TGeoToG4")
+      << "The ROOT geometry was loaded with Geant4 units; only ROOT units are supported.\n";
+  }
+  lengthUnit_ = CLHEP::cm;
+  energyUnit_ = CLHEP::GeV;
+  timeUnit_ = CLHEP::s;
+
+  TGeoVolume const* top = geoManager.GetTopVolume();
+  if (!top) { throw cet::exception("TGeoToG4") << "The ROOT geometry has no top volume.\n"; }
+  G4LogicalVolume* worldLV = volume(top);
+  auto world = new G4PVPlacement(
+    nullptr, G4ThreeVector{}, worldLV, top->GetName(), nullptr, false, 0, checkOverlaps_);
+  convertSurfaces(geoManager);
+
+  mf::LogInfo("TGeoToG4") << "Converted the ROOT geometry: " << materials_.size()
+                          << " materials, " << solids_.size() << " solids, " << volumes_.size()
+                          << " logical volumes, " << placements_.size() + 1 << " placements.";
+  return world;
+}
+
+//-----------------------------------------------------------------------------
+G4Material* larg4::TGeoToG4::material(TGeoMaterial const* mat)
+{
+  if (auto it = materials_.find(mat); it != materials_.end()) return it->second;
+
+  std::string const name = mat->GetName();
+  G4Material* result = G4Material::GetMaterial(name, false);
+  if (!result && name.rfind("G4_", 0) == 0) {
+    result = G4NistManager::Instance()->FindOrBuildMaterial(name);
+  }
+  if (!result) {
+    G4State state = kStateUndefined;
+    switch (mat->GetState()) {
+    case TGeoMaterial::kMatStateSolid: state = kStateSolid; break;
+    case TGeoMaterial::kMatStateLiquid: state = kStateLiquid; break;
+    case TGeoMaterial::kMatStateGas: state = kStateGas; break;
+    default: break;
+    }
+    double const density = mat->GetDensity() * CLHEP::g / CLHEP::cm3;
+    double const temperature =
+      mat->GetTemperature() > 0. ? mat->GetTemperature() * CLHEP::kelvin : CLHEP::STP_Temperature;
+
+    auto element = [](TGeoElement const* el) {
+      constexpr double molarMass = CLHEP::g / CLHEP::mole;
+      if (G4Element* existing = G4Element::GetElement(el->GetName(), false)) return existing;
+      if (!el->HasIsotopes()) {
+        return new G4Element(el->GetName(), el->GetTitle(), el->Z(), el->A() * molarMass);
+      }
+      auto g4el = new G4Element(el->GetName(), el->GetTitle(), el->GetNisotopes());
+      for (int i = 0; i < el->GetNisotopes(); ++i) {
+        TGeoIsotope const* iso = el->GetIsotope(i);
+        G4Isotope* isotope = G4Isotope::GetIsotope(iso->GetName(), false);
+        if (!isotope) {
+          isotope = new G4Isotope(
+            iso->GetName(), iso->GetZ(), iso->GetN(), iso->GetA() * molarMass);
+        }
+        g4el->AddIsotope(isotope, el->GetRelativeAbundance(i));
+      }
+      return g4el;
+    };
+
+    if (mat->IsMixture()) {
+      auto mix = static_cast<TGeoMixture const*>(mat);
+      result = new G4Material(name, density, mix->GetNelements(), state, temperature);
+      for (int i = 0; i < mix->GetNelements(); ++i) {
+        result->AddElement(element(mix->GetElement(i)), mix->GetWmixt()[i]);
+      }
+    }
+    else {
+      result = new G4Material(name, density, 1, state, temperature);
+      result->AddElement(element(mat->GetElement()), 1.);
+    }
+
+    // -- optical properties
+    auto scale = [this](std::string const& property) {
+      switch (propertyUnit(property)) {
+      case PropertyUnit::Length: return lengthUnit_;
+      case PropertyUnit::Time: return timeUnit_;
+      case PropertyUnit::PerEnergy: return 1. / energyUnit_;
+      case PropertyUnit::None: break;
+      }
+      return 1.;
+    };
+    G4MaterialPropertiesTable* mpt = nullptr;
+    TIter nextProperty(&mat->GetProperties());
+    while (auto property = static_cast<TNamed const*>(nextProperty())) {
+      TGDMLMatrix const* matrix = mat->GetProperty(property->GetName());
+      if (!matrix || matrix->GetCols() != 2) continue;
+      std::vector<G4double> energies, values;
+      double const unit = scale(property->GetName());
+      for (size_t row = 0; row < matrix->GetRows(); ++row) {
+        energies.push_back(matrix->Get(row, 0) * energyUnit_);
+        values.push_back(matrix->Get(row, 1) * unit);
+      }
+      if (!mpt) mpt = new G4MaterialPropertiesTable;
+      mpt->AddProperty(property->GetName(), energies, values, true);
+    }
+    TIter nextConst(&mat->GetConstProperties());
+    while (auto property = static_cast<TNamed const*>(nextConst())) {
+      Bool_t error = false;
+      double const value = mat->GetConstProperty(property->GetName(), &error);
+      if (error) continue;
+      if (!mpt) mpt = new G4MaterialPropertiesTable;
+      mpt->AddConstProperty(property->GetName(), value * scale(property->GetName()), true);
+    }
+    if (mpt) result->SetMaterialPropertiesTable(mpt);
+  }
+  materials_.emplace(mat, result);
+  return result;
+}
+
+//-----------------------------------------------------------------------------
+G4VSolid* larg4::TGeoToG4::solid(TGeoShape const* shape)
+{
+  if (auto it = solids_.find(shape); it != solids_.end()) return it->second;
+
+  // shapes derived from the supported classes describe other solids: match
+  // the classes exactly
+  std::string const name = shape->GetName();
+  double const l = lengthUnit_;
+  G4VSolid* result = nullptr;
+  if (auto s = exactly<TGeoTubeSeg>(shape)) {
+    result = new G4Tubs(name,
+                        s->GetRmin() * l,
+                        s->GetRmax() * l,
+                        s->GetDz() * l,
+                        s->GetPhi1() * CLHEP::deg,
+                        (s->GetPhi2() - s->GetPhi1()) * CLHEP::deg);
+  }
+  else if (auto s = exactly<TGeoTube>(shape)) {
+    result = new G4Tubs(
+      name, s->GetRmin() * l, s->GetRmax() * l, s->GetDz() * l, 0., CLHEP::twopi);
+  }
+  else if (auto s = exactly<TGeoConeSeg>(shape)) {
+    result = new G4Cons(name,
+                        s->GetRmin1() * l,
+                        s->GetRmax1() * l,
+                        s->GetRmin2() * l,
+                        s->GetRmax2() * l,
+                        s->GetDz() * l,
+                        s->GetPhi1() * CLHEP::deg,
+                        (s->GetPhi2() - s->GetPhi1()) * CLHEP::deg);
+  }
+  else if (auto s = exactly<TGeoCone>(shape)) {
+    result = new G4Cons(name,
+                        s->GetRmin1() * l,
+                        s->GetRmax1() * l,
+                        s->GetRmin2() * l,
+                        s->GetRmax2() * l,
+                        s->GetDz() * l,
+                        0.,
+                        CLHEP::twopi);
+  }
+  else if (auto s = exactly<TGeoTrd1>(shape)) {
+    result = new G4Trd(
+      name, s->GetDx1() * l, s->GetDx2() * l, s->GetDy() * l, s->GetDy() * l, s->GetDz() * l);
+  }
+  else if (auto s = exactly<TGeoTrd2>(shape)) {
+    result = new G4Trd(
+      name, s->GetDx1() * l, s->GetDx2() * l, s->GetDy1() * l, s->GetDy2() * l, s->GetDz() * l);
+  }
+  else if (auto s = exactly<TGeoSphere>(shape)) {
+    result = new G4Sphere(name,
+                          s->GetRmin() * l,
+                          s->GetRmax() * l,
+                          s->GetPhi1() * CLHEP::deg,
+                          (s->GetPhi2() - s->GetPhi1()) * CLHEP::deg,
+                          s->GetTheta1() * CLHEP::deg,
+                          (s->GetTheta2() - s->GetTheta1()) * CLHEP::deg);
+  }
+  else if (shape->IsA() == TGeoPcon::Class() || shape->IsA() == TGeoPgon::Class()) {
+    auto s = static_cast<TGeoPcon const*>(shape);
+    std::vector<G4double> z, rmin, rmax;
+    for (int i = 0; i < s->GetNz(); ++i) {
+      z.push_back(s->GetZ(i) * l);
+      rmin.push_back(s->GetRmin(i) * l);
+      rmax.push_back(s->GetRmax(i) * l);
+    }
+    if (auto pgon = exactly<TGeoPgon>(shape)) {
+      result = new G4Polyhedra(name,
+                               s->GetPhi1() * CLHEP::deg,
+                               s->GetDphi() * CLHEP::deg,
+                               pgon->GetNedges(),
+                               s->GetNz(),
+                               z.data(),
+                               rmin.data(),
+                               rmax.data());
+    }
+    else {
+      result = new G4Polycone(name,
+                              s->GetPhi1() * CLHEP::deg,
+                              s->GetDphi() * CLHEP::deg,
+                              s->GetNz(),
+                              z.data(),
+                              rmin.data(),
+                              rmax.data());
+    }
+  }
+  else if (auto s = exactly<TGeoCompositeShape>(shape)) {
+    TGeoBoolNode const* node = s->GetBoolNode();
+    G4VSolid* left = solid(node->GetLeftShape());
+    G4VSolid* right = solid(node->GetRightShape());
+    TGeoMatrix const* leftMatrix = node->GetLeftMatrix();
+    if (leftMatrix && !leftMatrix->IsIdentity()) {
+      left = new G4DisplacedSolid(name + "_left", left, transform(leftMatrix, l));
+    }
+    G4Transform3D const rightTransform = transform(node->GetRightMatrix(), l);
+    switch (node->GetBooleanOperator()) {
+    case TGeoBoolNode::kGeoUnion:
+      result = new G4UnionSolid(name, left, right, rightTransform);
+      break;
+    case TGeoBoolNode::kGeoSubtraction:
+      result = new G4SubtractionSolid(name, left, right, rightTransform);
+      break;
+    case TGeoBoolNode::kGeoIntersection:
+      result = new G4IntersectionSolid(name, left, right, rightTransform);
+      break;
+    }
+  }
+  else if (auto s = exactly<TGeoBBox>(shape)) {
+    result = new G4Box(name, s->GetDX() * l, s->GetDY() * l, s->GetDZ() * l);
+  }
+  if (!result) {
+    throw cet::exception("TGeoToG4")
+      << "Shape " << name << " of class " << shape->ClassName() << " cannot be converted.\n";
+  }
+  solids_.emplace(shape, result);
+  return result;
+}
+
+//-----------------------------------------------------------------------------
+G4LogicalVolume* larg4::TGeoToG4::volume(TGeoVolume const* vol)
+{
+  if (auto it = volumes_.find(vol); it != volumes_.end()) return it->second;
+  if (vol->IsAssembly()) {
+    throw cet::exception("TGeoToG4")
+      << "Assembly volume " << vol->GetName() << " cannot be converted.\n";
+  }
+
+  // the logical volume is created before its daughters, so that the world
+  // comes first in the logical volume store
+  auto lv =
+    new G4LogicalVolume(solid(vol->GetShape()), material(vol->GetMaterial()), vol->GetName());
+  volumes_.emplace(vol, lv);
+  volumesByName_.emplace(vol->GetName(), lv);
+
+  for (int i = 0; i < vol->GetNdaughters(); ++i) {
+    TGeoNode const* node = vol->GetNode(i);
+    G4LogicalVolume* daughter = volume(node->GetVolume());
+    placements_.emplace(node,
+                        new G4PVPlacement(transform(node->GetMatrix(), lengthUnit_),
+                                          daughter,
+                                          node->GetName(),
+                                          lv,
+                                          false,
+                                          node->GetNumber(),
+                                          checkOverlaps_));
+  }
+  return lv;
+}
+
+//-----------------------------------------------------------------------------
+void larg4::TGeoToG4::convertSurfaces(TGeoManager& geoManager) const
+{
+  auto opticalSurface = [this](TGeoOpticalSurface const* surface) {
+    // the ROOT enumerations mirror the Geant4 ones
+    auto const model = static_cast<G4OpticalSurfaceModel>(surface->GetModel());
+    auto result = new G4OpticalSurface(surface->GetName(),
+                                       model,
+                                       static_cast<G4OpticalSurfaceFinish>(surface->GetFinish()),
+                                       static_cast<G4SurfaceType>(surface->GetType()));
+    // as in G4GDMLReadSolids: the value is the polish for the glisur model,
+    // sigma alpha otherwise
+    if (model == glisur)
+      result->SetPolish(surface->GetValue());
+    else
+      result->SetSigmaAlpha(surface->GetValue());
+
+    G4MaterialPropertiesTable* mpt = nullptr;
+    TIter next(&surface->GetProperties());
+    while (auto property = static_cast<TNamed const*>(next())) {
+      TGDMLMatrix const* matrix = surface->GetProperty(property->GetName());
+      if (!matrix || matrix->GetCols() != 2) continue;
+      std::vector<G4double> energies, values;
+      for (size_t row = 0; row < matrix->GetRows(); ++row) {
+        energies.push_back(matrix->Get(row, 0) * energyUnit_);
+        values.push_back(matrix->Get(row, 1));
+      }
+      if (!mpt) mpt = new G4MaterialPropertiesTable;
+      mpt->AddProperty(property->GetName(), energies, values, true);
+    }
+    if (mpt) result->SetMaterialPropertiesTable(mpt);
+    return result;
+  };
+
+  if (TObjArray const* borders = geoManager.GetListOfBorderSurfaces()) {
+    for (TObject const* object : *borders) {
+      auto border = static_cast<TGeoBorderSurface const*>(object);
+      auto pv1 = placements_.find(border->GetNode1());
+      auto pv2 = placements_.find(border->GetNode2());
+      if (pv1 == placements_.end() || pv2 == placements_.end()) {
+        throw cet::exception("TGeoToG4")
+          << "Border surface " << border->GetName() << " refers to an unknown placement.\n";
+      }
+      new G4LogicalBorderSurface(
+        border->GetName(), pv1->second, pv2->second, opticalSurface(border->GetSurface()));
+    }
+  }
+  if (TObjArray const* skins = geoManager.GetListOfSkinSurfaces()) {
+    for (TObject const* object : *skins) {
+      auto skin = static_cast<TGeoSkinSurface const*>(object);
+      auto lv = volumes_.find(skin->GetVolume());
+      if (lv == volumes_.end()) {
+        throw cet::exception("TGeoToG4")
+          << "Skin surface " << skin->GetName() << " refers to an unknown volume.\n";
+      }
+      new G4LogicalSkinSurface(skin->GetName(), lv->second, opticalSurface(skin->GetSurface()));
+    }
+  }
+}
+
+//-----------------------------------------------------------------------------
+G4GDMLAuxMapType const& larg4::TGeoToG4::readAuxiliaryMap(std::string const& gdmlFile)
+{
+  auxMap_.clear();
+  auxLists_.clear();
+  // -- the volumes may be defined in the files the top file includes
+  for (auto const& [path, text] : readGDMLFiles(gdmlFile)) {
+    std::size_t pos = 0;
+    while ((pos = text.find("<volume", pos)) != std::string::npos) {
+      pos += 7;
+      if (!std::isspace(static_cast<unsigned char>(text[pos]))) continue; // e.g. <volumeref>
+      auto const tagEnd = text.find('>', pos);
+      auto const end = text.find("</volume>", tagEnd);
+      if (end == std::string::npos) break;
+      auto it = volumesByName_.find(attribute(text.substr(pos - 1, tagEnd - pos + 1), "name"));
+      if (it != volumesByName_.end()) {
+        for (auto aux = text.find("<auxiliary", tagEnd); aux < end;
+             aux = text.find("<auxiliary", aux)) {
+          aux = readAuxiliary(text, aux, auxMap_[it->second], auxLists_);
+        }
+      }
+      pos = end;
+    }
+  }
+  return auxMap_;
+}
@@ -0,0 +1,77 @@
+//=============================================================================
+// TGeoToG4.h:
+// Builds the Geant4 geometry from the ROOT TGeo geometry that geo::Geometry
+// has already loaded from the same GDML file, so that LArG4DetectorService
+// does not need to parse the GDML file a second time.
+//
+// Materials (with their optical property tables), solids, logical volumes,
+// placements and optical border and skin surfaces are converted.  TGeo does
+// not keep the GDML auxiliary information: it is read from the <volume>
+// elements of the GDML file, and of the files it includes, with a
+// lightweight scan instead.
+//
+// Only constructs LArSoft geometries use are supported (box, tube, cone,
+// trapezoid, sphere, polycone, polyhedra and boolean shapes, simple
+// placements) in a geometry loaded with ROOT units; anything else throws.
+//=============================================================================
+
+#ifndef LARG4_SERVICES_TGEOTOG4_H
+#define LARG4_SERVICES_TGEOTOG4_H
+
+#include "Geant4/G4GDMLAuxStructType.hh"
+#include "Geant4/G4GDMLReadStructure.hh"
+
+#include <deque>
+#include <map>
+#include <string>
+
+class G4LogicalVolume;
+class G4Material;
+class G4VPhysicalVolume;
+class G4VSolid;
+class TGeoManager;
+class TGeoMaterial;
+class TGeoNode;
+class TGeoShape;
+class TGeoVolume;
+
+namespace larg4 {
+
+  class TGeoToG4 {
+  public:
+    /// `checkOverlaps` is passed on to every placement.
+    explicit TGeoToG4(bool checkOverlaps = false) : checkOverlaps_{checkOverlaps} {}
+
+    /// Converts the whole TGeo tree; returns the world volume.  The world
+    /// logical volume is the first one created and the world placement the
+    /// last one, as with G4GDMLParser.
+    G4VPhysicalVolume* convert(TGeoManager& geoManager);
+
+    /// Reads the auxiliary information of the volumes from `gdmlFile` and
+    /// the files it includes; only volumes converted by convert() are kept.
+    G4GDMLAuxMapType const& readAuxiliaryMap(std::string const& gdmlFile);
+
+  private:
+    G4Material* material(TGeoMaterial const* material);
+    G4VSolid* solid(TGeoShape const* shape);
+    G4LogicalVolume* volume(TGeoVolume const* volume);
+    void convertSurfaces(TGeoManager& geoManager) const;
+
+    bool checkOverlaps_;
+    double lengthUnit_{};
+    double energyUnit_{};
+    double timeUnit_{};
+
+    std::map<TGeoMaterial const*, G4Material*> materials_;
+    std::map<TGeoShape const*, G4VSolid*> solids_;
+    std::map<TGeoVolume const*, G4LogicalVolume*> volumes_;
+    std::map<TGeoNode const*, G4VPhysicalVolume*> placements_;
+    std::map<std::string, G4LogicalVolume*> volumesByName_;
+
+    G4GDMLAuxMapType auxMap_;
+    std::deque<G4GDMLAuxListType> auxLists_; ///< storage of nested auxiliary lists
+  };
+
+} // namespace larg4
+
+#endif // LARG4_SERVICES_TGEOTOG4_H
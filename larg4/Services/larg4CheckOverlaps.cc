@@ -0,0 +1,103 @@
+//=============================================================================
+// larg4CheckOverlaps.cc:
+// Offline overlap check of a GDML geometry.
+//
+// The GDML file is looked up and parsed as LArG4DetectorService does, the
+// placements are checked in parallel (see OverlapCheck.h) and the result is
+// written to a file keyed by the content hash of the GDML file.  Pointing
+// the OverlapCheckDir parameter of LArG4DetectorService to the output
+// directory makes every job report the geometry as verified at startup.
+//
+// Usage:
+//   larg4CheckOverlaps [-j threads] [-n points] [-t tolerance_mm] [-o dir] file.gdml
+//=============================================================================
+
+#include "larg4/Services/GeometryCache.h"
+#include "larg4/Services/OverlapCheck.h"
+
+#include "artg4tk/pluginDetectors/gdml/ColorReader.hh"
+#include "cetlib/search_path.h"
+#include "cetlib_except/exception.h"
+
+#include "Geant4/G4GDMLParser.hh"
+
+#include <algorithm>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <thread>
+
+namespace {
+  void usage(char const* program)
+  {
+    std::cerr << "Usage: " << program
+              << " [-j threads] [-n points] [-t tolerance_mm] [-o output_dir] file.gdml\n"
+              << "  -j  number of threads (default: all hardware threads)\n"
+              << "  -n  points sampled on the surface of each placement (default: 10000)\n"
+              << "  -t  tolerance in mm (default: 0)\n"
+              << "  -o  directory of the result file (default: .)\n";
+  }
+}
+
+int main(int argc, char** argv)
+{
+  unsigned nThreads = std::max(std::thread::hardware_concurrency(), 1u);
+  int points = 10000;
+  double tolerance = 0.;
+  std::string outputDir = ".";
+  std::string gdmlFileName;
+  for (int i = 1; i < argc; ++i) {
+    std::string const arg = argv[i];
+    bool const hasValue = i + 1 < argc;
+    if (arg == "-j" && hasValue)
+      nThreads = std::atoi(argv[++i]);
+    else if (arg == "-n" && hasValue)
+      points = std::atoi(argv[++i]);
+    else if (arg == "-t" && hasValue)
+      tolerance = std::atof(argv[++i]);
+    else if (arg == "-o" && hasValue)
+      outputDir = argv[++i];
+    else if (arg[0] != '-' && gdmlFileName.empty())
+      gdmlFileName = arg;
+    else {
+      usage(argv[0]);
+      return 1;
+    }
+  }
+  if (gdmlFileName.empty() || points <= 0) {
+    usage(argv[0]);
+    return 1;
+  }
+
+  try {
+    cet::search_path sp{"FW_SEARCH_PATH"};
+    std::string fullGDMLFileName;
+    if (!sp.find_file(gdmlFileName, fullGDMLFileName)) {
+      throw cet::exception("larg4CheckOverlaps") << "Cannot find file: " << gdmlFileName;
+    }
+    ColorReader reader;
+    G4GDMLParser parser(&reader);
+    parser.SetOverlapCheck(false);
+    parser.Read(fullGDMLFileName, false);
+
+    nThreads = larg4::overlapCheckThreads(nThreads);
+    auto result = larg4::checkOverlaps(points, tolerance, nThreads);
+    result.gdmlHash = larg4::GeometryCache::contentHash(fullGDMLFileName);
+    auto const resultFileName =
+      larg4::overlapResultFileName(outputDir, fullGDMLFileName, result.gdmlHash);
+    larg4::writeOverlapResult(resultFileName, result);
+
+    std::cout << "Checked " << result.placements << " placements of " << fullGDMLFileName
+              << " with " << points << " points each on " << nThreads << " threads: "
+              << result.overlaps.size() << " overlap(s).\n";
+    for (auto const& overlap : result.overlaps) {
+      std::cout << "  " << overlap << '\n';
+    }
+    std::cout << "Result written to " << resultFileName << '\n';
+    return result.overlaps.empty() ? 0 : 2;
+  }
+  catch (cet::exception const& e) {
+    std::cerr << e.what() << '\n';
+    return 1;
+  }
+}
@@ -0,0 +1,244 @@
+//=============================================================================
+// larg4MakeShowerLibrary.cc:
+// Builds the frozen-shower library read by FrozenShowerModel.
+//
+// Showers of each particle type are simulated from the origin along +z in
+// a large block of a single material, with the full physics and the same
+// SimEnergyDepositSD as the detector simulation.  The primary energies are
+// drawn uniformly in each energy bin; the deposits of a shower are merged
+// into cubic voxels (energy-weighted position) and written as the
+// spots of the library (see FrozenShowerLibrary.h).
+//
+// Usage:
+//   larg4MakeShowerLibrary [-m material] [-l physics_list] [-p particles]
+//                          [-e edges_MeV] [-n showers] [-v voxel_mm] [-s seed]
+//                          -o library.bin
+//=============================================================================
+
+#include "larg4/Services/FrozenShowerLibrary.h"
+#include "larg4/Services/SimEnergyDepositSD.h"
+
+#include "cetlib_except/exception.h"
+
+#include "Geant4/G4Box.hh"
+#include "Geant4/G4Event.hh"
+#include "Geant4/G4LogicalVolume.hh"
+#include "Geant4/G4NistManager.hh"
+#include "Geant4/G4PVPlacement.hh"
+#include "Geant4/G4ParticleGun.hh"
+#include "Geant4/G4ParticleTable.hh"
+#include "Geant4/G4PhysListFactory.hh"
+#include "Geant4/G4RunManager.hh"
+#include "Geant4/G4SDManager.hh"
+#include "Geant4/G4SystemOfUnits.hh"
+#include "Geant4/G4VUserDetectorConstruction.hh"
+#include "Geant4/G4VUserPrimaryGeneratorAction.hh"
+#include "Geant4/Randomize.hh"
+
+#include <array>
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <map>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace {
+  void usage(char const* program)
+  {
+    std::cerr << "Usage: " << program
+              << " [-m material] [-l physics_list] [-p particles] [-e edges_MeV] [-n showers]"
+              << " [-v voxel_mm] [-s seed] -o library.bin\n"
+              << "  -m  NIST material of the block (default: G4_lAr)\n"
+              << "  -l  reference physics list (default: FTFP_BERT_EMZ)\n"
+              << "  -p  comma-separated particle names (default: e-,e+,gamma)\n"
+              << "  -e  comma-separated energy bin edges in MeV (default: 1,2,5,10,20,50)\n"
+              << "  -n  showers per bin (default: 100)\n"
+              << "  -v  voxel size in mm (default: 1)\n"
+              << "  -s  random seed (default: 12345)\n"
+              << "  -o  output library file\n";
+  }
+
+  std::vector<std::string> split(std::string const& list)
+  {
+    std::vector<std::string> items;
+    std::istringstream ss{list};
+    for (std::string item; std::getline(ss, item, ',');) {
+      if (!item.empty()) items.push_back(item);
+    }
+    return items;
+  }
+
+  // A block of material, large enough to contain the showers, made sensitive
+  class LibraryDetector : public G4VUserDetectorConstruction {
+  public:
+    explicit LibraryDetector(std::string const& material) : material_{material} {}
+
+    G4VPhysicalVolume* Construct() override
+    {
+      G4Material* material = G4NistManager::Instance()->FindOrBuildMaterial(material_);
+      if (!material) {
+        throw cet::exception("larg4MakeShowerLibrary") << "Unknown material " << material_;
+      }
+      auto box = new G4Box("ShowerBlock", 10. * m, 10. * m, 10. * m);
+      volume_ = new G4LogicalVolume(box, material, "ShowerBlock");
+      return new G4PVPlacement(nullptr, {}, volume_, "ShowerBlock", nullptr, false, 0);
+    }
+
+    void ConstructSDandField() override
+    {
+      larg4::SimEnergyDepositSDOptions options;
+      options.countPhotons = false;
+      options.countElectrons = false;
+      sd_ = larg4::makeSimEnergyDepositSD("ShowerBlock_SimEnergyDeposit", options);
+      G4SDManager::GetSDMpointer()->AddNewDetector(sd_);
+      SetSensitiveDetector(volume_, sd_);
+    }
+
+    larg4::SimEnergyDepositSD const& sd() const { return *sd_; }
+
+  private:
+    std::string material_;
+    G4LogicalVolume* volume_{nullptr};
+    larg4::SimEnergyDepositSD* sd_{nullptr};
+  };
+
+  class LibraryGun : public G4VUserPrimaryGeneratorAction {
+  public:
+    LibraryGun() : gun_{1}
+    {
+      gun_.SetParticlePosition({});
+      gun_.SetParticleMomentumDirection({0., 0., 1.});
+    }
+    void GeneratePrimaries(G4Event* event) override { gun_.GeneratePrimaryVertex(event); }
+    G4ParticleGun& gun() { return gun_; }
+
+  private:
+    G4ParticleGun gun_;
+  };
+
+  // Merges the deposits of the last shower into voxels
+  std::vector<larg4::FrozenShowerLibrary::Spot> spotsOf(sim::SimEnergyDepositCollection const& hits,
+                                                        double voxel)
+  {
+    struct Sum {
+      double e{}, x{}, y{}, z{};
+    };
+    std::map<std::array<long, 3>, Sum> voxels;
+    for (auto const& hit : hits) {
+      auto const mid = hit.MidPoint();
+      double const x = mid.X() * cm, y = mid.Y() * cm, z = mid.Z() * cm;
+      double const e = hit.E();
+      Sum& sum = voxels[{std::lround(std::floor(x / voxel)),
+                         std::lround(std::floor(y / voxel)),
+                         std::lround(std::floor(z / voxel))}];
+      sum.e += e;
+      sum.x += e * x;
+      sum.y += e * y;
+      sum.z += e * z;
+    }
+    std::vector<larg4::FrozenShowerLibrary::Spot> spots;
+    spots.reserve(voxels.size());
+    for (auto const& [key, sum] : voxels) {
+      if (!(sum.e > 0.)) continue;
+      spots.push_back({float(sum.x / sum.e / mm),
+                       float(sum.y / sum.e / mm),
+                       float(sum.z / sum.e / mm),
+                       float(sum.e)});
+    }
+    return spots;
+  }
+}
+
+int main(int argc, char** argv)
+{
+  std::string material = "G4_lAr";
+  std::string physicsList = "FTFP_BERT_EMZ";
+  std::string particles = "e-,e+,gamma";
+  std::string edges = "1,2,5,10,20,50";
+  int showers = 100;
+  double voxel = 1.;
+  long seed = 12345;
+  std::string outputFile;
+  for (int i = 1; i < argc; ++i) {
+    std::string const arg = argv[i];
+    bool const hasValue = i + 1 < argc;
+    if (arg == "-m" && hasValue)
+      material = argv[++i];
+    else if (arg == "-l" && hasValue)
+      physicsList = argv[++i];
+    else if (arg == "-p" && hasValue)
+      particles = argv[++i];
+    else if (arg == "-e" && hasValue)
+      edges = argv[++i];
+    else if (arg == "-n" && hasValue)
+      showers = std::atoi(argv[++i]);
+    else if (arg == "-v" && hasValue)
+      voxel = std::atof(argv[++i]);
+    else if (arg == "-s" && hasValue)
+      seed = std::atol(argv[++i]);
+    else if (arg == "-o" && hasValue)
+      outputFile = argv[++i];
+    else {
+      usage(argv[0]);
+      return 1;
+    }
+  }
+  std::vector<double> energyEdges;
+  for (auto const& edge : split(edges)) {
+    energyEdges.push_back(std::atof(edge.c_str()));
+  }
+  bool sorted = energyEdges.size() >= 2;
+  for (std::size_t i = 1; sorted && i < energyEdges.size(); ++i) {
+    sorted = energyEdges[i] > energyEdges[i - 1] && energyEdges[i - 1] > 0.;
+  }
+  if (outputFile.empty() || showers <= 0 || !(voxel > 0.) || !sorted) {
+    usage(argv[0]);
+    return 1;
+  }
+
+  try {
+    CLHEP::HepRandom::setTheSeed(seed);
+    auto runManager = new G4RunManager;
+    runManager->SetVerboseLevel(0);
+    auto detector = new LibraryDetector{material};
+    auto gun = new LibraryGun;
+    runManager->SetUserInitialization(detector);
+    runManager->SetUserInitialization(G4PhysListFactory{}.GetReferencePhysList(physicsList));
+    runManager->SetUserAction(gun);
+    runManager->Initialize();
+
+    larg4::FrozenShowerLibrary::Content content;
+    for (auto const& name : split(particles)) {
+      G4ParticleDefinition* particle = G4ParticleTable::GetParticleTable()->FindParticle(name);
+      if (!particle) {
+        throw cet::exception("larg4MakeShowerLibrary") << "Unknown particle " << name;
+      }
+      gun->gun().SetParticleDefinition(particle);
+      auto& bins = content[particle->GetPDGEncoding()];
+      for (std::size_t i = 1; i < energyEdges.size(); ++i) {
+        auto& bin = bins.emplace_back();
+        bin.minEnergy = energyEdges[i - 1];
+        bin.maxEnergy = energyEdges[i];
+        for (int k = 0; k < showers; ++k) {
+          G4double const energy =
+            energyEdges[i - 1] + (energyEdges[i] - energyEdges[i - 1]) * G4UniformRand();
+          gun->gun().SetParticleEnergy(energy * MeV);
+          runManager->BeamOn(1);
+          bin.showers.emplace_back(energy, spotsOf(detector->sd().GetHits(), voxel * mm));
+        }
+        std::cout << name << " " << bin.minEnergy << "-" << bin.maxEnergy << " MeV: " << showers
+                  << " showers\n";
+      }
+    }
+    larg4::FrozenShowerLibrary::write(outputFile, content);
+    std::cout << "Wrote " << outputFile << "\n";
+    delete runManager;
+  }
+  catch (cet::exception const& e) {
+    std::cerr << e.what() << "\n";
+    return 2;
+  }
+  return 0;
+}
@@ -0,0 +1,25 @@
+////////////////////////////////////////////////////////////////////////
+/// \file  GeneratorPolicy.h
+/// \brief Simulation policy for the particles of one generator.
+///
+/// The policies are configured in ParticleListActionService
+/// (GeneratorPolicies), which keeps a copy of the policy of the track
+/// being simulated, read by the sensitive detectors through a pointer.
+////////////////////////////////////////////////////////////////////////
+
+#ifndef LARG4_PLUGINACTIONS_GENERATORPOLICY_H
+#define LARG4_PLUGINACTIONS_GENERATORPOLICY_H
+
+namespace larg4 {
+
+  struct GeneratorPolicy {
+    double energyCut{0.};          ///< minimum energy of a particle to be in the particle list
+    bool secondaryParticles{true}; ///< whether particles beyond the primaries are listed
+    bool droppedAncestry{true};    ///< whether the ancestry of dropped particles is kept
+    bool simEnergyDeposits{true};  ///< whether SimEnergyDepositSD records the deposits
+    bool auxDetHits{true};         ///< whether AuxDetSD records the hits
+  };
+
+}
+
+#endif // LARG4_PLUGINACTIONS_GENERATORPOLICY_H
@@ -1,9 +1,12 @@
 #include "larg4/pluginActions/MCTruthEventAction_service.h"
+#include "larg4/Services/Hash.h"
+#include "larg4/Services/LArG4Detector_service.h"
 
 #include "nug4/G4Base/PrimaryParticleInformation.h"
 
 #include "nusimdata/SimulationBase/MCParticle.h"
 
+#include "art/Framework/Services/Registry/ServiceHandle.h"
 #include "canvas/Persistency/Common/Ptr.h"
 
 #include "messagefacility/MessageLogger/MessageLogger.h"
@@ -18,13 +21,16 @@
 #include "Geant4/G4PrimaryVertex.hh"
 #include "Geant4/G4Types.hh"
 
-#include "CLHEP/Vector/LorentzVector.h"
-
 #include "TLorentzVector.h"
 #include "TVector3.h"
 
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <cstdlib>
 #include <sstream>
 #include <string>
+#include <unordered_map>
 
 using std::string;
 
@@ -35,12 +41,34 @@ namespace {
     constexpr int genieHiPdg = 2000000300;
     return pdg >= genieLoPdg && pdg <= genieHiPdg;
   }
+
+  // Vertex position (x, y, z, t)
+  using FourPosition = std::array<G4double, 4>;
+
+  struct FourPositionHash {
+    std::size_t operator()(FourPosition p) const noexcept
+    {
+      for (G4double& v : p) {
+        if (v == 0.) v = 0.; // -0 and +0 compare equal
+      }
+      return larg4::fnv1a(p.data(), sizeof p);
+    }
+  };
+
+  // Upper bound of the vertex map reservation; events with more vertices rehash.
+  constexpr std::size_t maxReservedVertices = 1 << 20;
 }
 
 G4ParticleTable* larg4::MCTruthEventActionService::fParticleTable = nullptr;
 
 larg4::MCTruthEventActionService::MCTruthEventActionService(fhicl::ParameterSet const& p)
   : PrimaryGeneratorActionBase(p.get<string>("name", "MCTruthEventActionService"))
+  , fFilterPrimaries(p.get<bool>("FilterPrimaries", false))
+  , fFilter{p.get<double>("FilterMargin", 10.) * CLHEP::cm,
+            p.get<double>("FilterGammaMargin", 30.) * CLHEP::cm,
+            p.get<double>("FilterChargedRangePerMeV", 1.) * CLHEP::cm,
+            p.get<double>("FilterChargedKeepEnergy", 0.1) * CLHEP::GeV,
+            {}}
 {}
 
 larg4::MCTruthEventActionService::~MCTruthEventActionService()
@@ -71,6 +99,18 @@ larg4::MCTruthEventActionService::~MCTruthEventActionService()
                                        << "They were not processed by Geant4." << non1txt.str();
   }
 
+  // Print out a list of primaries skipped by the geometric filter
+  if (!fFilteredPDG.empty()) {
+    std::ostringstream filteredtxt;
+    G4int total = 0;
+    for (auto const [pdg, n] : fFilteredPDG) {
+      filteredtxt << "\n   PDG code = " << pdg << ", skipped " << n << " times.";
+      total += n;
+    }
+    mf::LogInfo("MCTruthEventAction") << total << " primaries could not reach a sensitive volume "
+                                      << "and were not processed by Geant4." << filteredtxt.str();
+  }
+
   // Print out a list of PDG codes that were processed
   if (!fProcessedPDG.empty()) {
     std::ostringstream goodtxt;
@@ -83,6 +123,40 @@ larg4::MCTruthEventActionService::~MCTruthEventActionService()
   }
 }
 
+// Returns Geant4's definition of the particle, or nullptr if it is unknown to
+// Geant4; each PDG code is resolved once per job.
+G4ParticleDefinition* larg4::MCTruthEventActionService::FindDefinition(G4int pdgCode)
+{
+  auto [it, inserted] = fDefinitions.try_emplace(pdgCode, nullptr);
+  if (!inserted) { return it->second; }
+
+  if (pdgCode >= 2'000'000'000) { // If the particle is generator-specific
+    mf::LogDebug("ConvertPrimaryToGeant4")
+      << ": %%% Will skip particle with generator-specific PDG code = " << pdgCode;
+    return nullptr;
+  }
+
+  G4ParticleDefinition* particleDefinition = nullptr;
+  if (pdgCode == 0) { particleDefinition = fParticleTable->FindParticle("opticalphoton"); }
+  else {
+    particleDefinition = fParticleTable->FindParticle(pdgCode);
+  }
+
+  // If the particle is a nucleus and the particle table doesn't have a
+  // definition yet, ask the ion table for one. This will create a new ion
+  // definition as needed.
+  if (!particleDefinition && pdgCode > 1'000'000'000) {
+    int const Z = (pdgCode % 10'000'000) / 10'000; // atomic number
+    int const A = (pdgCode % 10'000) / 10;         // mass number
+    particleDefinition = fParticleTable->GetIonTable()->GetIon(Z, A, 0.);
+  }
+
+  if (particleDefinition == nullptr) {
+    mf::LogDebug("ConvertPrimaryToGeant4") << ": %%% Code not found = " << pdgCode;
+  }
+  return it->second = particleDefinition;
+}
+
 // Create a primary particle for an event!
 // (Standard Art G4 simulation)
 void larg4::MCTruthEventActionService::generatePrimaries(G4Event* anEvent)
@@ -94,16 +168,48 @@ void larg4::MCTruthEventActionService::generatePrimaries(G4Event* anEvent)
   size_t mclSize = mclistHandles.size(); // -- should match the number of generators
   mf::LogDebug("generatePrimaries") << "MCTruth Handles Size: " << mclSize;
 
+  // -- Particles share a vertex when their four-positions are identical
+  size_t nParticles = 0;
+  size_t nMCTruths = 0;
+  for (auto const& mclistHandle : mclistHandles) {
+    for (simb::MCTruth const& mct : *mclistHandle) {
+      if (nMCTruths >= fFirstMCTruth && nMCTruths < fLastMCTruth) nParticles += mct.NParticles();
+      ++nMCTruths;
+    }
+  }
+  std::unordered_map<FourPosition, G4PrimaryVertex*, FourPositionHash> vertexMap;
+  vertexMap.reserve(std::min(nParticles, maxReservedVertices));
+
+  // Get the particle table if necessary.  (Note: we're doing
+  // this "late" because I'm not sure at what point the G4
+  // particle table is initialized in the loading process.)
+  if (fParticleTable == nullptr) { fParticleTable = G4ParticleTable::GetParticleTable(); }
+
+  // -- The sensitive volumes are known once the geometry is built
+  if (fFilterPrimaries && !fSensitiveBoxesLoaded) {
+    for (auto const& box : art::ServiceHandle<LArG4DetectorService>()->sensitiveBoundingBoxes()) {
+      fFilter.boxes.emplace_back(box.min, box.max);
+    }
+    fSensitiveBoxesLoaded = true;
+    if (fFilter.boxes.empty()) {
+      mf::LogWarning("generatePrimaries")
+        << "No sensitive volumes found: the primaries will not be filtered.";
+    }
+  }
+  bool const filter = fFilterPrimaries && !fFilter.boxes.empty();
+  size_t nFiltered = 0;
+
   // -- Loop over MCTruth Handle List
   size_t index = 0;
-  std::map<CLHEP::HepLorentzVector, G4PrimaryVertex*> vertexMap;
   for (size_t mcl = 0; mcl < mclSize; ++mcl) {
     mf::LogDebug("generatePrimaries")
       << "MCTruth Handle Number: " << (mcl + 1) << " of " << mclSize;
     art::Handle<std::vector<simb::MCTruth>> mclistHandle = mclistHandles[mcl];
     // Loop over all MCTruth handle entries for a given generator,
     // usually only one, but you never know
-    for (size_t i = 0; i < mclistHandle->size(); ++i) {
+    for (size_t i = 0; i < mclistHandle->size(); ++i, ++index) {
+      // -- MCTruth objects outside the range are tracked in another sub-event
+      if (index < fFirstMCTruth || index >= fLastMCTruth) continue;
       art::Ptr<simb::MCTruth> mclist(mclistHandle, i);
 
       mf::LogDebug("generatePrimaries")
@@ -137,73 +243,48 @@ void larg4::MCTruthEventActionService::generatePrimaries(G4Event* anEvent)
         G4double z = particle.Vz() * CLHEP::cm;
         G4double t = particle.T() * CLHEP::ns;
 
-        // Create a CLHEP four-vector from the particle's vertex.
-        CLHEP::HepLorentzVector fourpos(x, y, z, t);
-
-        // Is this vertex already in our map?
-        G4PrimaryVertex* vertex = nullptr;
-        auto result = vertexMap.find(fourpos);
-        if (result == vertexMap.end()) {
-          // No, it's not, so create a new vertex and add it to the map.
-          vertex = new G4PrimaryVertex(x, y, z, t);
-          vertexMap[fourpos] = vertex;
-
-          // Add the vertex to the G4Event.
-          anEvent->AddPrimaryVertex(vertex);
-        }
-        else {
-          // Yes, it is, so use the existing vertex.
-          vertex = result->second;
-        }
-
         // Get additional particle information.
         TLorentzVector const& momentum = particle.Momentum(); // (px,py,pz,E)
         TVector3 const& polarization = particle.Polarization();
 
-        // Get the particle table if necessary.  (Note: we're doing
-        // this "late" because I'm not sure at what point the G4
-        // particle table is initialized in the loading process.)
-        if (fParticleTable == nullptr) { fParticleTable = G4ParticleTable::GetParticleTable(); }
-
-        // Get Geant4's definition of the particle.
-        G4ParticleDefinition* particleDefinition = nullptr;
-
-        if (pdgCode == 0) { particleDefinition = fParticleTable->FindParticle("opticalphoton"); }
-        else {
-          particleDefinition = fParticleTable->FindParticle(pdgCode);
-        }
-
-        if (pdgCode >= 2'000'000'000) { // If the particle is generator-specific
-          mf::LogDebug("ConvertPrimaryToGeant4")
-            << ": %%% Will skip particle with generator-specific PDG code = " << pdgCode;
-          fUnknownPDG[pdgCode] += 1;
-          continue;
-        }
-        if (pdgCode > 1'000'000'000) { // If the particle is a nucleus
+        if (pdgCode > 1'000'000'000 && pdgCode < 2'000'000'000) { // If the particle is a nucleus
           mf::LogDebug("ConvertPrimaryToGeant4")
             << ": %%% Nuclear PDG code = " << pdgCode << " (x,y,z,t)=(" << x << "," << y << "," << z
             << "," << t << ")"
             << " P=" << momentum.P() << ", E=" << momentum.E();
-          // If the particle table doesn't have a definition yet, ask
-          // the ion table for one. This will create a new ion
-          // definition as needed.
-          if (!particleDefinition) {
-            int const Z = (pdgCode % 10'000'000) / 10'000; // atomic number
-            int const A = (pdgCode % 10'000) / 10;         // mass number
-            particleDefinition = fParticleTable->GetIonTable()->GetIon(Z, A, 0.);
-          }
         }
 
+        // Get Geant4's definition of the particle.
+        G4ParticleDefinition* particleDefinition = FindDefinition(pdgCode);
+
         // What if the PDG code is unknown?  This has been a known
         // issue with GENIE.
         if (particleDefinition == nullptr) {
-          mf::LogDebug("ConvertPrimaryToGeant4") << ": %%% Code not found = " << pdgCode;
           fUnknownPDG[pdgCode] += 1;
           continue;
         }
 
+        if (filter && pdgCode != 0 &&
+            !fFilter.mayReach(*particleDefinition,
+                              G4ThreeVector(x, y, z),
+                              G4ThreeVector(momentum.Px(), momentum.Py(), momentum.Pz()),
+                              (momentum.E() - momentum.M()) * CLHEP::GeV)) {
+          fFilteredPDG[pdgCode] += 1;
+          ++nFiltered;
+          continue;
+        }
+
         fProcessedPDG[pdgCode] += 1;
 
+        // Is this vertex already in our map?
+        auto [result, inserted] = vertexMap.try_emplace(FourPosition{x, y, z, t}, nullptr);
+        if (inserted) {
+          // No, it's not, so create a new vertex and add it to the G4Event.
+          result->second = new G4PrimaryVertex(x, y, z, t);
+          anEvent->AddPrimaryVertex(result->second);
+        }
+        G4PrimaryVertex* vertex = result->second;
+
         // Create a Geant4 particle to add to the vertex.
         auto* g4particle = new G4PrimaryParticle(particleDefinition,
                                                  momentum.Px() * CLHEP::GeV,
@@ -229,7 +310,10 @@ void larg4::MCTruthEventActionService::generatePrimaries(G4Event* anEvent)
         // G4PrimaryParticle for access during tracking.
         g4particle->SetUserInformation(primaryParticleInfo);
       } // -- for each particle in MCTruth
-      ++index;
-    } // -- for each MCTruth entry
+    }   // -- for each MCTruth entry
   }   // -- for each MCTruth handle
+  if (filter) {
+    mf::LogDebug("generatePrimaries")
+      << nFiltered << " primaries cannot reach a sensitive volume and were skipped";
+  }
 } // -- generatePrimaries()
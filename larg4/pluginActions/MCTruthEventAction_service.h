@@ -11,11 +11,35 @@
 // Expected parameters:
 // - name (string): A name describing the action service.
 //       Default is 'exampleParticleGun'
+// - FilterPrimaries (bool): skip primaries which cannot reach the bounding box
+//       of any sensitive volume of LArG4DetectorService (default: false).
+//       Unstable particles (including neutrons), nuclei (radioactive ones are
+//       flagged stable in their ground state) and charged particles above
+//       FilterChargedKeepEnergy are always tracked.
+//       A stable neutral primary is kept if its line of flight passes within
+//       FilterMargin (+ FilterGammaMargin for photons) of a box; a stable
+//       charged one if a box lies within its range, estimated as
+//       FilterChargedRangePerMeV times its kinetic energy, plus FilterMargin
+//       (+ FilterGammaMargin for electrons and positrons, whose photons
+//       travel further).
+//       The ranges and margins are lengths, so the defaults only hold for
+//       primaries starting in LAr or media of similar density (~1.4 g/cm3);
+//       scale them by 1.4 g/cm3 over the density of the medium the primaries
+//       start in, e.g. x0.5 for rock (~2.7 g/cm3). Gaps of air or vacuum
+//       between the start and the boxes lengthen the reach; they are not
+//       accounted for, so grow FilterMargin by their width.
+// - FilterMargin (double, cm): default 10
+// - FilterGammaMargin (double, cm): default 30 (two radiation lengths of LAr)
+// - FilterChargedRangePerMeV (double, cm/MeV): default 1, about twice the
+//       range per MeV of a minimum-ionizing particle in LAr (2.1 MeV/cm)
+// - FilterChargedKeepEnergy (double, GeV): kinetic energy, default 0.1
 
 // Include guard
 #ifndef MCTRUTHEVENTACTION_SERVICE_HH
 #define MCTRUTHEVENTACTION_SERVICE_HH
 
+#include "larg4/pluginActions/PrimaryFilter.h"
+
 #include "artg4tk/actionBase/PrimaryGeneratorActionBase.hh"
 
 #include "nusimdata/SimulationBase/MCTruth.h"
@@ -30,9 +54,13 @@ namespace fhicl {
 #include "Geant4/G4Types.hh"
 
 class G4Event;
+class G4ParticleDefinition;
 class G4ParticleTable;
 
+#include <cstddef>
+#include <limits>
 #include <map>
+#include <unordered_map>
 #include <vector>
 
 namespace larg4 {
@@ -47,11 +75,20 @@ namespace larg4 {
       fMCLists = &mclists;
     }
 
+    /// Restricts the next generatePrimaries() to the MCTruth objects with an
+    /// index (counted over all input collections) in [first, last).
+    void setMCTruthRange(std::size_t first, std::size_t last)
+    {
+      fFirstMCTruth = first;
+      fLastMCTruth = last;
+    }
+
   private:
     // To generate primaries, we need to overload the GeneratePrimaries
     // method.
 
     void generatePrimaries(G4Event* anEvent) override;
+    G4ParticleDefinition* FindDefinition(G4int pdgCode);
 
     static G4ParticleTable* fParticleTable; ///< Geant4's table of particle definitions.
     std::vector<art::Handle<std::vector<simb::MCTruth>>> const*
@@ -59,6 +96,14 @@ namespace larg4 {
     std::map<G4int, G4int> fUnknownPDG;    ///< map of unknown PDG codes to instances
     std::map<G4int, G4int> fNon1StatusPDG; ///< PDG codes skipped because not status 1
     std::map<G4int, G4int> fProcessedPDG;  ///< PDG codes processed
+    std::unordered_map<G4int, G4ParticleDefinition*> fDefinitions; ///< resolved PDG codes
+
+    bool fFilterPrimaries; ///< whether to skip primaries out of reach
+    PrimaryFilter fFilter; ///< filled with the sensitive boxes at the first event
+    bool fSensitiveBoxesLoaded{false};
+    std::map<G4int, G4int> fFilteredPDG; ///< PDG codes of the skipped primaries
+    std::size_t fFirstMCTruth{0};          ///< first MCTruth index to generate
+    std::size_t fLastMCTruth{std::numeric_limits<std::size_t>::max()}; ///< past the last one
   };
 } //namespace larg4
 
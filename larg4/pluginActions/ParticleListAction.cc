@@ -134,12 +134,56 @@ namespace larg4 {
     if (fSparsifyTrajectories)
       mf::LogInfo("ParticleListActionService")
         << "Trajectory sparsification enabled with SparsifyMargin : " << fSparsifyMargin << "\n";
+
+    // -- per-generator policies; the other generators follow the global settings
+    fDefaultPolicy.energyCut = fenergyCut;
+    for (auto const& ps : p.get<std::vector<fhicl::ParameterSet>>("GeneratorPolicies", {})) {
+      auto const generator = ps.get<std::string>("Generator");
+      GeneratorPolicy policy = fDefaultPolicy;
+      policy.energyCut = ps.get<double>("EnergyCut", fenergyCut);
+      policy.secondaryParticles = ps.get<bool>("SecondaryMCParticles", true);
+      policy.droppedAncestry = ps.get<bool>("KeepDroppedAncestry", true);
+      auto const recorded = ps.get<std::vector<std::string>>("RecordDeposits",
+                                                             {"SimEnergyDeposit", "AuxDet"});
+      policy.simEnergyDeposits = policy.auxDetHits = false;
+      for (auto const& sd : recorded) {
+        if (sd == "SimEnergyDeposit") { policy.simEnergyDeposits = true; }
+        else if (sd == "AuxDet") {
+          policy.auxDetHits = true;
+        }
+        else {
+          throw art::Exception(art::errors::Configuration)
+            << "ParticleListActionService: unknown RecordDeposits entry \"" << sd
+            << "\" for generator " << generator << " (SimEnergyDeposit, AuxDet).\n";
+        }
+      }
+      if (!fGeneratorPolicies.emplace(generator, policy).second) {
+        throw art::Exception(art::errors::Configuration)
+          << "ParticleListActionService: two GeneratorPolicies for " << generator << ".\n";
+      }
+      mf::LogInfo("ParticleListActionService")
+        << "Generator " << generator << ": energy cut " << policy.energyCut
+        << (policy.secondaryParticles ? ", all" : ", primary") << " MCParticles"
+        << (policy.droppedAncestry ? "" : ", no dropped-particle ancestry")
+        << (policy.simEnergyDeposits ? "" : ", no SimEnergyDeposits")
+        << (policy.auxDetHits ? "" : ", no AuxDetHits");
+    }
   } // end constructor
 
   //----------------------------------------------------------------------------
   // Begin the event
   void ParticleListActionService::beginOfEventAction(const G4Event*)
   {
+    if (!fFirstSubEvent) {
+      // Continue the particle list of the art event; every track seen so far
+      // is in fTargetIDMap, so the new tracks are numbered after the last one.
+      fCurrentParticle.clear();
+      fCurrentTrackID = sim::NoParticleId;
+      fTrackIDOffset = fTargetIDMap.empty() ? 0 : fTargetIDMap.rbegin()->first + 1;
+      fSubEventTrackIDOffset = fTrackIDOffset;
+      return;
+    }
+
     // Clear any previous particle information.
     fCurrentParticle.clear();
     fParticleList.clear();
@@ -148,9 +192,12 @@ namespace larg4 {
     fMCTIndexMap.clear();
     fMCTPrimProcessKeepMap.clear();
     fCurrentTrackID = sim::NoParticleId;
+    fCurrentPolicy = fDefaultPolicy;
     fTrackIDOffset = 0;
+    fSubEventTrackIDOffset = 0;
     fPrimaryTruthMap.clear();
     fMCTIndexToGeneratorMap.clear();
+    fMCTIndexPolicy.clear();
     fNotStoredCounterUMap.clear();
     fdroppedTracksMap.clear();
     if (fdroppedParticleList) fdroppedParticleList->clear();
@@ -199,6 +246,9 @@ namespace larg4 {
         }
       }
       fMCTIndexToGeneratorMap.emplace(mcti, std::make_pair(generator_name, keepGen));
+      auto const policy = fGeneratorPolicies.find(generator_name);
+      fMCTIndexPolicy.push_back(policy == fGeneratorPolicies.end() ? &fDefaultPolicy :
+                                                                      &policy->second);
       sskeepgen << "\n\tTrajectory points storable : " << (keepGen ? "true" : "false") << "\n";
       mf::LogDebug("beginOfEventAction::Generator") << sskeepgen.str();
     }
@@ -268,6 +318,7 @@ namespace larg4 {
     const G4PrimaryParticle* primaryParticle = dynamicParticle->GetPrimaryParticle();
     simb::GeneratedParticleIndex_t primaryIndex = simb::NoGeneratedParticleIndex;
     size_t primarymctIndex = 0;
+    fCurrentPolicy = fDefaultPolicy;
     if (primaryParticle != nullptr) {
       const G4VUserPrimaryParticleInformation* gppi = primaryParticle->GetUserInformation();
       const g4b::PrimaryParticleInformation* ppi =
@@ -275,6 +326,7 @@ namespace larg4 {
       if (ppi != nullptr) {
         primaryIndex = ppi->MCParticleIndex();
         primarymctIndex = ppi->MCTruthIndex();
+        fCurrentPolicy = *PolicyOf(primarymctIndex);
         mct_primary_process = ppi->GetMCParticle()->Process();
 
         // If we've made it this far, a PrimaryParticleInformation
@@ -325,6 +377,10 @@ namespace larg4 {
       // one of pair production, compton scattering, photoelectric effect
       // bremstrahlung, annihilation, or ionization
       process_name = track->GetCreatorProcess()->GetProcessName();
+      // the policy of the generator follows the MCTruth index of the parent
+      if (auto it = fMCTIndexMap.find(parentID); it != cend(fMCTIndexMap)) {
+        fCurrentPolicy = *PolicyOf(it->second);
+      }
       if (!fKeepEMShowerDaughters) {
         for (auto const& p : fNotStoredPhysics) {
           if (process_name.find(p) != std::string::npos) {
@@ -354,7 +410,9 @@ namespace larg4 {
           fTargetIDMap[trackID] = fCurrentTrackID;
           // clear current particle as we are not stepping this particle and
           // adding trajectory points to it
-          fdroppedTracksMap[this->GetParentage(trackID)].insert(trackID);
+          if (fCurrentPolicy.droppedAncestry) {
+            fdroppedTracksMap[this->GetParentage(trackID)].insert(trackID);
+          }
           // keep track of this particle in the fMCTIndexMap as well, as we may keep a daughter
           if (auto it = fMCTIndexMap.find(parentID); it != cend(fMCTIndexMap)) {
             fMCTIndexMap[trackID] = it->second;
@@ -363,7 +421,8 @@ namespace larg4 {
           if (auto it = fMCTIndexMap.find(parentID); it != cend(fMCTIndexMap)) {
             fMCTIndexMap[trackID] = it->second;
           }
-          if (!fStoreDroppedMCParticles) { //Only clear if not storing dropped particles
+          //Only clear if not storing dropped particles
+          if (!fStoreDroppedMCParticles || !fCurrentPolicy.droppedAncestry) {
             fCurrentParticle.clear();
             return;
           }
@@ -371,10 +430,13 @@ namespace larg4 {
       }   // end if not keeping EM shower daughters
 
       // Check the energy of the particle.  If it falls below the energy
-      // cut, don't add it to our list.
+      // cut, or its generator lists only primaries, don't add it to our list.
       G4double energy = track->GetKineticEnergy();
-      if (energy < fenergyCut && pdgCode != 0) {
-        fdroppedTracksMap[this->GetParentage(trackID)].insert(trackID);
+      if ((energy < fCurrentPolicy.energyCut && pdgCode != 0) ||
+          !fCurrentPolicy.secondaryParticles) {
+        if (fCurrentPolicy.droppedAncestry) {
+          fdroppedTracksMap[this->GetParentage(trackID)].insert(trackID);
+        }
         fCurrentParticle.clear();
         // do add the particle to the parent id map though
         // and set the current track id to be it's ultimate parent
@@ -549,8 +611,10 @@ namespace larg4 {
       }
       //
       int const trackID = aTrack->GetTrackID() + fTrackIDOffset;
-      int parentID = aTrack->GetParentID() + fTrackIDOffset;
-      fdroppedTracksMap[parentID].insert(trackID);
+      // primaries keep parentID = 0 in every sub-event, as in preUserTrackingAction
+      int const parentID =
+        aTrack->GetParentID() == 0 ? 0 : aTrack->GetParentID() + fTrackIDOffset;
+      if (fCurrentPolicy.droppedAncestry) fdroppedTracksMap[parentID].insert(trackID);
       fCurrentParticle.clear();
       // do add the particle to the parent id map though
       // and set the current track id to be it's ultimate parent
@@ -791,6 +855,9 @@ namespace larg4 {
   // event and pass the call on to the action objects.
   void ParticleListActionService::endOfEventAction(const G4Event*)
   {
+    // More sub-events of this art event follow; the products are made after the last one.
+    if (!fLastSubEvent) return;
+
     // -- End of Run Report
     if (!fNotStoredCounterUMap.empty()) { // -- Only if there is something to report
       std::stringstream sscounter;
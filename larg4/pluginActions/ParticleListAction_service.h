@@ -30,6 +30,7 @@
 
 #include "larcore/Geometry/Geometry.h"
 #include "larcorealg/CoreUtils/ParticleFilters.h"
+#include "larg4/pluginActions/GeneratorPolicy.h"
 
 #include "art/Framework/Principal/Handle.h"
 #include "art/Framework/Services/Registry/ServiceDeclarationMacros.h"
@@ -118,7 +119,21 @@ namespace larg4 {
       return std::move(tpassn_);
     }
 
-    std::map<int, int> GetTargetIDMap() { return fTargetIDMap; }
+    std::map<int, int> const& GetTargetIDMap() const { return fTargetIDMap; }
+
+    /// Marks the next Geant4 event as a sub-event of the current art event:
+    /// the first one starts the particle list, the following ones add to it
+    /// with their track IDs offset past all earlier tracks, and the products
+    /// are made at the end of the last one.
+    void setSubEvent(bool first, bool last)
+    {
+      fFirstSubEvent = first;
+      fLastSubEvent = last;
+    }
+    bool IsLastSubEvent() const { return fLastSubEvent; }
+
+    /// Offset added to the Geant4 track IDs of the current sub-event
+    int GetSubEventTrackIDOffset() const { return fSubEventTrackIDOffset; }
 
     /// Grabs a particle filter
     void CreateParticleFilter(std::vector<std::string> keepParticlesInVolumes,
@@ -174,6 +189,10 @@ namespace larg4 {
     /// Return whether dropped particles are stored
     bool storeDropped() const { return fStoreDroppedMCParticles; }
 
+    /// Policy of the generator of the track being simulated; the pointer
+    /// stays valid, the policy it points to changes with the track
+    GeneratorPolicy const* CurrentGeneratorPolicy() const { return &fCurrentPolicy; }
+
   private:
     struct ParticleInfo_t {
       simb::MCParticle* particle = nullptr; ///< simple structure representing particle
@@ -229,6 +248,12 @@ namespace larg4 {
     // parentage of the provided trackid
     int GetParentage(int trackid) const;
 
+    // Policy of the particles from the MCTruth with index mctIndex
+    GeneratorPolicy const* PolicyOf(size_t mctIndex) const
+    {
+      return mctIndex < fMCTIndexPolicy.size() ? fMCTIndexPolicy[mctIndex] : &fDefaultPolicy;
+    }
+
     G4double fenergyCut;             ///< The minimum energy for a particle to
                                      ///< be included in the list.
     ParticleInfo_t fCurrentParticle; ///< information about the particle currently being simulated
@@ -249,6 +274,9 @@ namespace larg4 {
                                  ///< for EM shower particles
     mutable int fTrackIDOffset;  ///< offset added to track ids when running over
                                  ///< multiple MCTruth objects.
+    int fSubEventTrackIDOffset{0}; ///< track ID offset of the current sub-event
+    bool fFirstSubEvent{true};     ///< whether the Geant4 event starts the art event
+    bool fLastSubEvent{true};      ///< whether the Geant4 event ends the art event
     bool fKeepEMShowerDaughters; ///< whether to keep EM shower secondaries, tertiaries, etc
     std::vector<std::string> fNotStoredPhysics; ///< Physics processes that will not be stored
     bool fkeepOnlyPrimaryFullTraj; ///< Whether to store trajectories only for primaries and
@@ -284,6 +312,18 @@ namespace larg4 {
     /// Map: MCTruthIndex -> generator, input label of generator and keepGenerator decision
     std::map<size_t, std::pair<std::string, G4bool>> fMCTIndexToGeneratorMap;
 
+    /// Policy of the generators not in GeneratorPolicies
+    GeneratorPolicy fDefaultPolicy;
+
+    /// Map: generator label -> policy from GeneratorPolicies
+    std::map<std::string, GeneratorPolicy> fGeneratorPolicies;
+
+    /// Policy of each MCTruthIndex in the event
+    std::vector<GeneratorPolicy const*> fMCTIndexPolicy;
+
+    /// Policy of the track being simulated, copied at each new track
+    GeneratorPolicy fCurrentPolicy;
+
     /// Map: not stored process and counter
     std::unordered_map<std::string, int> fNotStoredCounterUMap;
 
@@ -0,0 +1,84 @@
+//=============================================================================
+// PrimaryFilter.h:
+// Whether a primary particle may deposit energy in the bounding box of a
+// sensitive volume, for the FilterPrimaries option of MCTruthEventAction
+// (see MCTruthEventAction_service.h for the parameters).
+//=============================================================================
+
+#ifndef LARG4_PLUGINACTIONS_PRIMARYFILTER_H
+#define LARG4_PLUGINACTIONS_PRIMARYFILTER_H
+
+#include "Geant4/G4ParticleDefinition.hh"
+#include "Geant4/G4SystemOfUnits.hh"
+#include "Geant4/G4ThreeVector.hh"
+#include "Geant4/G4Types.hh"
+
+#include <algorithm>
+#include <cfloat>
+#include <cstdlib>
+#include <utility>
+#include <vector>
+
+namespace larg4 {
+
+  struct PrimaryFilter {
+    G4double margin;             ///< [mm]
+    G4double gammaMargin;        ///< added for photons [mm]
+    G4double chargedRangePerMeV; ///< [mm/MeV]
+    G4double chargedKeepEnergy;  ///< kinetic energy [MeV]
+    std::vector<std::pair<G4ThreeVector, G4ThreeVector>> boxes; ///< (min, max) [mm]
+
+    /// Whether the primary may deposit energy in one of the boxes.
+    bool mayReach(G4ParticleDefinition const& definition,
+                  G4ThreeVector const& position,
+                  G4ThreeVector const& momentum,
+                  G4double kineticEnergy) const
+    {
+      // -- decay products can go anywhere; ground-state nuclei of the ion
+      //    table are flagged stable even when radioactive
+      if (!definition.GetPDGStable() || definition.GetParticleType() == "nucleus") return true;
+
+      if (definition.GetPDGCharge() != 0.) {
+        if (kineticEnergy >= chargedKeepEnergy) return true;
+        G4double reach = kineticEnergy / CLHEP::MeV * chargedRangePerMeV + margin;
+        // -- electrons and positrons radiate, positrons also annihilate:
+        //    photons carry their energy beyond the range
+        if (std::abs(definition.GetPDGEncoding()) == 11) reach += gammaMargin;
+        for (auto const& [min, max] : boxes) {
+          G4ThreeVector const outside(
+            std::max({min.x() - position.x(), 0., position.x() - max.x()}),
+            std::max({min.y() - position.y(), 0., position.y() - max.y()}),
+            std::max({min.z() - position.z(), 0., position.z() - max.z()}));
+          if (outside.mag2() <= reach * reach) return true;
+        }
+        return false;
+      }
+
+      // -- neutral: does the line of flight cross a box grown by the margin?
+      G4double const grow = margin + (definition.GetPDGEncoding() == 22 ? gammaMargin : 0.);
+      G4ThreeVector const direction = momentum.unit();
+      for (auto const& [min, max] : boxes) {
+        G4double tmin = 0.;
+        G4double tmax = DBL_MAX;
+        for (int axis = 0; axis < 3; ++axis) {
+          G4double const lo = min[axis] - grow - position[axis];
+          G4double const hi = max[axis] + grow - position[axis];
+          if (direction[axis] == 0.) {
+            if (lo > 0. || hi < 0.) tmax = -1.;
+            continue;
+          }
+          G4double t1 = lo / direction[axis];
+          G4double t2 = hi / direction[axis];
+          if (t1 > t2) std::swap(t1, t2);
+          tmin = std::max(tmin, t1);
+          tmax = std::min(tmax, t2);
+        }
+        if (tmin <= tmax) return true;
+      }
+      return false;
+    }
+  };
+
+} // namespace larg4
+
+#endif // LARG4_PLUGINACTIONS_PRIMARYFILTER_H
@@ -0,0 +1,40 @@
+//=============================================================================
+// EventSeed_test.cc: values and range of larg4::eventSeed
+//=============================================================================
+
+#define BOOST_TEST_MODULE (EventSeed_test)
+#include "boost/test/unit_test.hpp"
+
+#include "larg4/Core/EventSeed.h"
+
+#include <set>
+
+BOOST_AUTO_TEST_CASE(seeds_are_stable)
+{
+  // -- the seeds of a job must not change with the platform or the release:
+  //    these values pin the hash
+  BOOST_TEST(larg4::eventSeed(12345, art::EventID(1, 0, 1), "largeant") == 756091914L);
+  BOOST_TEST(larg4::eventSeed(0, art::EventID(7, 3, 42), "") == 768522440L);
+}
+
+BOOST_AUTO_TEST_CASE(seeds_depend_on_every_argument)
+{
+  long const seed = larg4::eventSeed(12345, art::EventID(1, 0, 1), "largeant");
+  BOOST_TEST(larg4::eventSeed(12346, art::EventID(1, 0, 1), "largeant") != seed);
+  BOOST_TEST(larg4::eventSeed(12345, art::EventID(2, 0, 1), "largeant") != seed);
+  BOOST_TEST(larg4::eventSeed(12345, art::EventID(1, 1, 1), "largeant") != seed);
+  BOOST_TEST(larg4::eventSeed(12345, art::EventID(1, 0, 2), "largeant") != seed);
+  BOOST_TEST(larg4::eventSeed(12345, art::EventID(1, 0, 1), "largeant2") != seed);
+}
+
+BOOST_AUTO_TEST_CASE(seeds_are_valid_art_seeds)
+{
+  std::set<long> seeds;
+  for (unsigned event = 1; event <= 1000; ++event) {
+    long const seed = larg4::eventSeed(1, art::EventID(1, 0, event), "largeant");
+    BOOST_TEST(seed >= 1L);
+    BOOST_TEST(seed <= 900000000L);
+    seeds.insert(seed);
+  }
+  BOOST_TEST(seeds.size() == 1000u);
+}
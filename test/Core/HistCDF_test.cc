@@ -0,0 +1,89 @@
+//=============================================================================
+// HistCDF_test.cc: bin selection of the larg4::HistCDF sampling tables
+//=============================================================================
+
+#define BOOST_TEST_MODULE (HistCDF_test)
+#include "boost/test/unit_test.hpp"
+
+#include "larg4/Core/HistCDF.h"
+
+#include <initializer_list>
+
+namespace {
+
+  // 1D table with unit bins from 0 and the given contents
+  larg4::HistCDF table(std::initializer_list<double> contents)
+  {
+    larg4::HistCDF result;
+    for (double content : contents) {
+      result.xLow.push_back(result.xLow.size());
+      result.xWidth.push_back(1.);
+      result.addContent(content);
+    }
+    return result;
+  }
+
+}
+
+BOOST_AUTO_TEST_CASE(empty_tables_are_refused)
+{
+  BOOST_TEST(!table({}).normalize());
+  BOOST_TEST(!table({0., 0.}).normalize());
+  BOOST_TEST(table({0., 2.}).normalize());
+}
+
+BOOST_AUTO_TEST_CASE(bins_follow_their_content)
+{
+  auto h = table({1., 0., 3.});
+  BOOST_TEST_REQUIRE(h.normalize());
+  BOOST_TEST(h.cdf.back() == 1.);
+  BOOST_TEST(h.bin(0.) == 0u);
+  BOOST_TEST(h.bin(0.2499) == 0u);
+  // -- the empty bin is skipped
+  BOOST_TEST(h.bin(0.25) == 2u);
+  BOOST_TEST(h.bin(0.9999) == 2u);
+  BOOST_TEST(h.bin(1.) == 2u);
+}
+
+BOOST_AUTO_TEST_CASE(empty_edge_bins_are_never_picked)
+{
+  auto h = table({0., 0., 5., 0.});
+  BOOST_TEST_REQUIRE(h.normalize());
+  for (double u : {0., 0.3, 0.7, 0.99999}) {
+    BOOST_TEST(h.bin(u) == 2u);
+  }
+  BOOST_TEST(h.bin(1.) == 2u);
+}
+
+BOOST_AUTO_TEST_CASE(values_lie_in_the_picked_bin)
+{
+  auto h = table({1., 1.});
+  h.xLow = {-2., 0.};
+  h.xWidth = {2., 0.5};
+  BOOST_TEST_REQUIRE(h.normalize());
+  BOOST_TEST(h.select(0.1, 0.) == -2.);
+  BOOST_TEST(h.select(0.1, 0.5) == -1.);
+  BOOST_TEST(h.select(0.6, 0.5) == 0.25);
+}
+
+BOOST_AUTO_TEST_CASE(bins_of_2D_tables_are_x_major)
+{
+  // -- 2 x bins, 3 y bins; only (x 1, y 0) and (x 0, y 2) have content
+  larg4::HistCDF h;
+  h.xLow = {0., 10.};
+  h.xWidth = {10., 10.};
+  h.yLow = {-1., 0., 1.};
+  h.yWidth = {1., 1., 1.};
+  for (double content : {0., 0., 1., 3., 0., 0.}) {
+    h.addContent(content);
+  }
+  BOOST_TEST_REQUIRE(h.normalize());
+
+  double x = 0., y = 0.;
+  h.select(0.1, 0.5, 0.5, x, y);
+  BOOST_TEST(x == 5.);
+  BOOST_TEST(y == 1.5);
+  h.select(0.5, 0.5, 0.5, x, y);
+  BOOST_TEST(x == 15.);
+  BOOST_TEST(y == -0.5);
+}
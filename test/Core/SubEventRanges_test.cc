@@ -0,0 +1,48 @@
+//=============================================================================
+// SubEventRanges_test.cc: grouping of MCTruth objects by larg4::subEventRanges
+//=============================================================================
+
+#define BOOST_TEST_MODULE (SubEventRanges_test)
+#include "boost/test/unit_test.hpp"
+
+#include "larg4/Core/SubEventRanges.h"
+
+#include <cstddef>
+#include <limits>
+#include <utility>
+#include <vector>
+
+namespace {
+  using Ranges = std::vector<std::pair<std::size_t, std::size_t>>;
+  constexpr auto all = std::numeric_limits<std::size_t>::max();
+}
+
+BOOST_AUTO_TEST_CASE(no_limit_is_one_range)
+{
+  BOOST_TEST((larg4::subEventRanges({5, 5, 5}, 0) == Ranges{{0, all}}));
+  BOOST_TEST((larg4::subEventRanges({}, 0) == Ranges{{0, all}}));
+}
+
+BOOST_AUTO_TEST_CASE(no_input_is_one_range)
+{
+  BOOST_TEST((larg4::subEventRanges({}, 10) == Ranges{{0, all}}));
+}
+
+BOOST_AUTO_TEST_CASE(ranges_are_filled_up_to_the_limit)
+{
+  BOOST_TEST((larg4::subEventRanges({4, 6, 3, 7, 1}, 10) == Ranges{{0, 2}, {2, 4}, {4, all}}));
+  BOOST_TEST((larg4::subEventRanges({3, 3, 3, 3}, 10) == Ranges{{0, 3}, {3, all}}));
+  BOOST_TEST((larg4::subEventRanges({3, 3, 4}, 10) == Ranges{{0, all}}));
+}
+
+BOOST_AUTO_TEST_CASE(large_mctruth_is_not_split)
+{
+  // -- an MCTruth above the limit is a sub-event of its own
+  BOOST_TEST((larg4::subEventRanges({2, 25, 2}, 10) == Ranges{{0, 1}, {1, 2}, {2, all}}));
+  BOOST_TEST((larg4::subEventRanges({25}, 10) == Ranges{{0, all}}));
+}
+
+BOOST_AUTO_TEST_CASE(mctruth_without_primaries_joins_the_current_range)
+{
+  BOOST_TEST((larg4::subEventRanges({0, 10, 0, 1}, 10) == Ranges{{0, 3}, {3, all}}));
+}
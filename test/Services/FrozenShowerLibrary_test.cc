@@ -0,0 +1,118 @@
+//=============================================================================
+// FrozenShowerLibrary_test.cc: write/read round trip of larg4::FrozenShowerLibrary
+//=============================================================================
+
+#define BOOST_TEST_MODULE (FrozenShowerLibrary_test)
+#include "boost/test/unit_test.hpp"
+
+#include "larg4/Services/FrozenShowerLibrary.h"
+
+#include "PatchFile.h"
+
+#include "cetlib_except/exception.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <unistd.h>
+
+using larg4::FrozenShowerLibrary;
+using namespace larg4::test;
+using Header = FrozenShowerLibrary::Header;
+using Spot = FrozenShowerLibrary::Spot;
+
+namespace {
+
+  // Two bins of electrons, the second one with two showers, and one of photons
+  FrozenShowerLibrary::Content content()
+  {
+    FrozenShowerLibrary::Content result;
+    result[11] = {{1.f, 2.f, {{1.5f, {{0.f, 0.f, 1.f, 1.5f}}}}},
+                  {2.f,
+                   5.f,
+                   {{3.f, {{0.f, 0.f, 2.f, 1.f}, {0.5f, -0.5f, 6.f, 2.f}}},
+                    {4.f, {{0.f, 1.f, 3.f, 4.f}}}}}};
+    result[22] = {{1.f, 10.f, {{7.f, {{1.f, 2.f, 3.f, 7.f}}}}}};
+    return result;
+  }
+
+}
+
+BOOST_AUTO_TEST_CASE(round_trip)
+{
+  std::string const fileName = "round_trip.fsl";
+  FrozenShowerLibrary::write(fileName, content());
+  FrozenShowerLibrary const library{fileName};
+
+  BOOST_TEST(library.covers(11, 1.));
+  BOOST_TEST(library.covers(11, 4.9));
+  BOOST_TEST(!library.covers(11, 0.5));
+  BOOST_TEST(!library.covers(11, 5.));
+  BOOST_TEST(!library.covers(-11, 3.));
+  BOOST_TEST(library.maxEnergy(11) == 5.);
+  BOOST_TEST(library.maxEnergy(22) == 10.);
+  BOOST_TEST(library.maxEnergy(-11) == 0.);
+
+  auto const first = library.pick(11, 1.2, 0.99);
+  BOOST_TEST(first.energy == 1.5f);
+  BOOST_TEST_REQUIRE(std::distance(first.begin, first.end) == 1);
+  BOOST_TEST(first.begin->z == 1.f);
+
+  // -- u picks among the showers of the bin
+  auto const second = library.pick(11, 3., 0.2);
+  BOOST_TEST(second.energy == 3.f);
+  BOOST_TEST_REQUIRE(std::distance(second.begin, second.end) == 2);
+  BOOST_TEST(second.begin[1].x == 0.5f);
+  BOOST_TEST(second.begin[1].y == -0.5f);
+  BOOST_TEST(second.begin[1].z == 6.f);
+  BOOST_TEST(second.begin[1].e == 2.f);
+  auto const third = library.pick(11, 3., 0.7);
+  BOOST_TEST(third.energy == 4.f);
+  BOOST_TEST_REQUIRE(std::distance(third.begin, third.end) == 1);
+  BOOST_TEST(third.begin->e == 4.f);
+
+  auto const photon = library.pick(22, 9., 0.);
+  BOOST_TEST(photon.energy == 7.f);
+  BOOST_TEST(photon.begin->y == 2.f);
+
+  std::remove(fileName.c_str());
+}
+
+BOOST_AUTO_TEST_CASE(foreign_files_are_refused)
+{
+  std::string const fileName = "foreign.fsl";
+  std::ofstream{fileName} << "not a shower library, but long enough for a header";
+  BOOST_CHECK_THROW(FrozenShowerLibrary{fileName}, cet::exception);
+  std::remove(fileName.c_str());
+}
+
+BOOST_AUTO_TEST_CASE(other_versions_are_refused)
+{
+  // -- version 1 spots had a time: their size differs
+  std::string const fileName = "version1.fsl";
+  FrozenShowerLibrary::write(fileName, content());
+  patchAt(fileName, offsetof(Header, version), std::uint32_t{1});
+  BOOST_CHECK_THROW(FrozenShowerLibrary{fileName}, cet::exception);
+  std::remove(fileName.c_str());
+}
+
+BOOST_AUTO_TEST_CASE(spot_count_must_match_the_showers)
+{
+  std::string const fileName = "spots.fsl";
+  FrozenShowerLibrary::write(fileName, content());
+  auto const nSpots = readAt<std::uint64_t>(fileName, offsetof(Header, nSpots));
+
+  // -- more spots announced than stored
+  patchAt(fileName, offsetof(Header, nSpots), nSpots + 1);
+  BOOST_CHECK_THROW(FrozenShowerLibrary{fileName}, cet::exception);
+
+  // -- the last spot dropped: the size matches, the last shower does not
+  patchAt(fileName, offsetof(Header, nSpots), nSpots - 1);
+  BOOST_TEST(::truncate(fileName.c_str(), fileSize(fileName) - sizeof(Spot)) == 0);
+  BOOST_CHECK_THROW(FrozenShowerLibrary{fileName}, cet::exception);
+
+  std::remove(fileName.c_str());
+}
@@ -0,0 +1,196 @@
+//=============================================================================
+// GeometryCache_test.cc: store/load round trip of larg4::GeometryCache
+//=============================================================================
+
+#define BOOST_TEST_MODULE (GeometryCache_test)
+#include "boost/test/unit_test.hpp"
+
+#include "larg4/Services/GeometryCache.h"
+
+#include "PatchFile.h"
+
+#include "Geant4/G4Box.hh"
+#include "Geant4/G4LogicalVolume.hh"
+#include "Geant4/G4LogicalVolumeStore.hh"
+#include "Geant4/G4NistManager.hh"
+#include "Geant4/G4PVPlacement.hh"
+#include "Geant4/G4PhysicalVolumeStore.hh"
+#include "Geant4/G4SolidStore.hh"
+#include "Geant4/G4SystemOfUnits.hh"
+#include "Geant4/G4Transform3D.hh"
+#include "Geant4/G4Tubs.hh"
+#include "Geant4/G4UnionSolid.hh"
+
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <string>
+
+using namespace larg4::test;
+
+namespace {
+
+  std::string const directory = ".";
+
+  // -- a rotation and its inverse differ on these
+  G4RotationMatrix rotation30()
+  {
+    G4RotationMatrix r;
+    r.rotateZ(30. * deg);
+    return r;
+  }
+
+  bool sameRotation(G4RotationMatrix const& a, G4RotationMatrix const& b)
+  {
+    for (auto const& axis : {G4ThreeVector(1., 0., 0.), G4ThreeVector(0., 1., 0.)}) {
+      if ((a * axis - b * axis).mag() > 1e-9) return false;
+    }
+    return true;
+  }
+
+  // Points telling the +30 deg arm of the rotated boolean from a -30 deg one
+  G4ThreeVector const onArm{40. * std::cos(30. * deg) * mm, 40. * std::sin(30. * deg) * mm, 0.};
+  G4ThreeVector const offArm{40. * std::cos(30. * deg) * mm, -40. * std::sin(30. * deg) * mm, 0.};
+
+  std::string writeGDML(std::string const& name, std::string const& content)
+  {
+    std::string const path = directory + '/' + name;
+    std::ofstream{path} << content;
+    return path;
+  }
+
+  // World box with a tube of liquid argon, tagged as sensitive, off center,
+  // and a rotated placement of a small box joined with a rotated long arm
+  G4VPhysicalVolume* buildGeometry(G4GDMLAuxMapType& auxmap)
+  {
+    auto nist = G4NistManager::Instance();
+    auto worldLV = new G4LogicalVolume(
+      new G4Box("World", 1. * m, 1. * m, 1. * m), nist->FindOrBuildMaterial("G4_AIR"), "volWorld");
+    auto tpcLV = new G4LogicalVolume(new G4Tubs("TPC", 0., 10. * cm, 20. * cm, 0., 360. * deg),
+                                     nist->FindOrBuildMaterial("G4_lAr"),
+                                     "volTPCActive");
+    new G4PVPlacement(nullptr, {0., 5. * cm, 0.}, tpcLV, "volTPCActive_PV", worldLV, false, 3);
+    auxmap[tpcLV].push_back({"SensDet", "SimEnergyDeposit", "", nullptr});
+    auto const arm = new G4UnionSolid("Arm",
+                                      new G4Box("Hub", 10. * mm, 10. * mm, 10. * mm),
+                                      new G4Box("Spoke", 50. * mm, 5. * mm, 5. * mm),
+                                      G4Transform3D{rotation30(), {}});
+    auto armLV = new G4LogicalVolume(arm, nist->FindOrBuildMaterial("G4_Fe"), "volArm");
+    new G4PVPlacement(
+      G4Transform3D{rotation30(), {0., -50. * cm, 0.}}, armLV, "volArm_PV", worldLV, false, 0);
+    // -- the world is the last placement, as with the GDML parser
+    return new G4PVPlacement(nullptr, {}, worldLV, "volWorld_PV", nullptr, false, 0);
+  }
+
+  void clearGeometry()
+  {
+    G4PhysicalVolumeStore::Clean();
+    G4LogicalVolumeStore::Clean();
+    G4SolidStore::Clean();
+  }
+
+}
+
+BOOST_AUTO_TEST_CASE(round_trip)
+{
+  auto const gdml = writeGDML("round_trip.gdml", "<gdml><!-- round trip --></gdml>\n");
+  larg4::GeometryCache cache{directory, gdml};
+  std::remove(cache.fileName().c_str());
+
+  G4GDMLAuxMapType written;
+  G4VPhysicalVolume* original = buildGeometry(written);
+  G4VSolid const* originalArm =
+    original->GetLogicalVolume()->GetDaughter(1)->GetLogicalVolume()->GetSolid();
+  BOOST_TEST_REQUIRE(originalArm->Inside(onArm) == kInside);
+  BOOST_TEST_REQUIRE(originalArm->Inside(offArm) == kOutside);
+  BOOST_TEST(cache.store(original, written));
+  clearGeometry();
+
+  G4GDMLAuxMapType read;
+  G4VPhysicalVolume* world = larg4::GeometryCache{directory, gdml}.load(read);
+  BOOST_TEST_REQUIRE(world != nullptr);
+  BOOST_TEST(world->GetName() == "volWorld_PV");
+  BOOST_TEST(world->GetLogicalVolume()->GetMaterial()->GetName() == "G4_AIR");
+  BOOST_TEST_REQUIRE(world->GetLogicalVolume()->GetNoDaughters() == 2u);
+
+  G4VPhysicalVolume const* tpc = world->GetLogicalVolume()->GetDaughter(0);
+  BOOST_TEST(tpc->GetName() == "volTPCActive_PV");
+  BOOST_TEST(tpc->GetCopyNo() == 3);
+  BOOST_TEST(tpc->GetObjectTranslation() == G4ThreeVector(0., 5. * cm, 0.));
+  G4LogicalVolume const* tpcLV = tpc->GetLogicalVolume();
+  BOOST_TEST(tpcLV->GetName() == "volTPCActive");
+  BOOST_TEST(tpcLV->GetMaterial()->GetName() == "G4_lAr");
+  auto const tube = dynamic_cast<G4Tubs const*>(tpcLV->GetSolid());
+  BOOST_TEST_REQUIRE(tube != nullptr);
+  BOOST_TEST(tube->GetOuterRadius() == 10. * cm);
+  BOOST_TEST(tube->GetZHalfLength() == 20. * cm);
+
+  // -- rotations of placements and of boolean constituents are not inverted
+  G4VPhysicalVolume const* armPV = world->GetLogicalVolume()->GetDaughter(1);
+  BOOST_TEST(armPV->GetName() == "volArm_PV");
+  BOOST_TEST(sameRotation(armPV->GetObjectRotationValue(), rotation30()));
+  G4VSolid const* arm = armPV->GetLogicalVolume()->GetSolid();
+  BOOST_TEST(arm->Inside(onArm) == kInside);
+  BOOST_TEST(arm->Inside(offArm) == kOutside);
+
+  BOOST_TEST_REQUIRE(read.size() == 1u);
+  auto const& [volume, auxes] = *read.begin();
+  BOOST_TEST(volume == tpcLV);
+  BOOST_TEST_REQUIRE(auxes.size() == 1u);
+  BOOST_TEST(auxes.front().type == "SensDet");
+  BOOST_TEST(auxes.front().value == "SimEnergyDeposit");
+
+  clearGeometry();
+  std::remove(cache.fileName().c_str());
+}
+
+BOOST_AUTO_TEST_CASE(changed_gdml_is_not_loaded)
+{
+  auto const gdml = writeGDML("changed.gdml", "<gdml><!-- version 1 --></gdml>\n");
+  larg4::GeometryCache cache{directory, gdml};
+  G4GDMLAuxMapType auxmap;
+  BOOST_TEST(cache.store(buildGeometry(auxmap), auxmap));
+  clearGeometry();
+
+  writeGDML("changed.gdml", "<gdml><!-- version 2 --></gdml>\n");
+  larg4::GeometryCache changed{directory, gdml};
+  BOOST_TEST(changed.hash() != cache.hash());
+  BOOST_TEST(changed.load(auxmap) == nullptr);
+
+  std::remove(cache.fileName().c_str());
+}
+
+BOOST_AUTO_TEST_CASE(damaged_cache_is_not_loaded)
+{
+  auto const gdml = writeGDML("damaged.gdml", "<gdml><!-- damaged --></gdml>\n");
+  larg4::GeometryCache cache{directory, gdml};
+  G4GDMLAuxMapType auxmap;
+  BOOST_TEST(cache.store(buildGeometry(auxmap), auxmap));
+  clearGeometry();
+
+  // -- flip one byte of the payload: the checksum no longer matches
+  auto const byte = readAt<char>(cache.fileName(), 64);
+  patchAt(cache.fileName(), 64, static_cast<char>(byte ^ 0x5a));
+  BOOST_TEST(cache.load(auxmap) == nullptr);
+  BOOST_TEST(G4PhysicalVolumeStore::GetInstance()->empty());
+
+  std::remove(cache.fileName().c_str());
+}
+
+BOOST_AUTO_TEST_CASE(other_format_version_is_not_loaded)
+{
+  auto const gdml = writeGDML("version.gdml", "<gdml><!-- version --></gdml>\n");
+  larg4::GeometryCache cache{directory, gdml};
+  G4GDMLAuxMapType auxmap;
+  BOOST_TEST(cache.store(buildGeometry(auxmap), auxmap));
+  clearGeometry();
+
+  // -- the format version follows the 8-byte magic
+  auto const version = readAt<std::uint32_t>(cache.fileName(), 8);
+  patchAt(cache.fileName(), 8, version + 1);
+  BOOST_TEST(cache.load(auxmap) == nullptr);
+  BOOST_TEST(G4PhysicalVolumeStore::GetInstance()->empty());
+
+  std::remove(cache.fileName().c_str());
+}
@@ -0,0 +1,94 @@
+//=============================================================================
+// HitArena_test.cc: chunking, reset and history of larg4::HitArena
+//=============================================================================
+
+#define BOOST_TEST_MODULE (HitArena_test)
+#include "boost/test/unit_test.hpp"
+
+#include "larg4/Services/HitArena.h"
+
+#include <iterator>
+#include <numeric>
+#include <vector>
+
+BOOST_AUTO_TEST_CASE(chunk_size_is_a_power_of_two)
+{
+  BOOST_TEST(larg4::HitArena<int>(1).chunkSize() == 1u);
+  BOOST_TEST(larg4::HitArena<int>(3).chunkSize() == 4u);
+  BOOST_TEST(larg4::HitArena<int>(4096).chunkSize() == 4096u);
+  BOOST_TEST(larg4::HitArena<int>(0).chunkSize() == 1u);
+}
+
+BOOST_AUTO_TEST_CASE(hits_are_kept_in_order_across_chunks)
+{
+  larg4::HitArena<int> arena(4);
+  for (int i = 0; i < 10; ++i)
+    arena.push_back(i);
+  BOOST_TEST(arena.size() == 10u);
+  BOOST_TEST(arena.back() == 9);
+
+  std::vector<int> expected(10);
+  std::iota(expected.begin(), expected.end(), 0);
+  std::vector<int> const iterated(arena.begin(), arena.end());
+  BOOST_TEST(iterated == expected, boost::test_tools::per_element());
+  auto const copied = arena.to_collection();
+  BOOST_TEST(copied == expected, boost::test_tools::per_element());
+  BOOST_TEST(copied.capacity() == copied.size());
+  BOOST_TEST(std::distance(arena.begin(), arena.end()) == 10);
+}
+
+BOOST_AUTO_TEST_CASE(growth_does_not_move_stored_hits)
+{
+  larg4::HitArena<int> arena(4);
+  arena.push_back(0);
+  int const* first = &arena[0];
+  for (int i = 1; i < 100; ++i)
+    arena.push_back(i);
+  BOOST_TEST(first == &arena[0]);
+  BOOST_TEST(*first == 0);
+}
+
+BOOST_AUTO_TEST_CASE(reset_drops_the_hits)
+{
+  larg4::HitArena<int> arena(4);
+  for (int i = 0; i < 10; ++i)
+    arena.push_back(i);
+  arena.reset();
+  BOOST_TEST(arena.empty());
+  BOOST_TEST((arena.begin() == arena.end()));
+  arena.push_back(42);
+  BOOST_TEST(arena.size() == 1u);
+  BOOST_TEST(arena[0] == 42);
+}
+
+BOOST_AUTO_TEST_CASE(history_keeps_chunks_of_the_largest_recent_event)
+{
+  larg4::HitArena<int> arena(4, 2);
+  BOOST_TEST(arena.capacity() == 0u);
+  for (int i = 0; i < 12; ++i)
+    arena.push_back(i);
+  BOOST_TEST(arena.capacity() == 12u);
+
+  arena.reset(); // history: 12, 0
+  BOOST_TEST(arena.capacity() == 12u);
+  int const* kept = &arena[0];
+  arena.push_back(0);
+  BOOST_TEST(&arena[0] == kept); // the kept chunks are reused in place
+
+  arena.reset(); // history: 12, 1
+  BOOST_TEST(arena.capacity() == 12u);
+
+  arena.reset(); // history: 0, 1 -- the large event has left the history
+  BOOST_TEST(arena.capacity() == 4u);
+}
+
+BOOST_AUTO_TEST_CASE(reset_preallocates_for_the_history)
+{
+  larg4::HitArena<int> arena(4, 3);
+  arena.reset(); // an empty event still keeps one chunk
+  BOOST_TEST(arena.capacity() == 4u);
+  for (int i = 0; i < 9; ++i)
+    arena.push_back(i);
+  arena.reset();
+  BOOST_TEST(arena.capacity() == 12u);
+}
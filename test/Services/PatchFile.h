@@ -0,0 +1,40 @@
+//=============================================================================
+// PatchFile.h: in-place edits of binary files, to damage them in the tests
+// of the file formats
+//=============================================================================
+
+#ifndef LARG4_TEST_SERVICES_PATCHFILE_H
+#define LARG4_TEST_SERVICES_PATCHFILE_H
+
+#include <cstddef>
+#include <fstream>
+#include <string>
+
+namespace larg4::test {
+
+  template <typename T>
+  T readAt(std::string const& fileName, std::size_t offset)
+  {
+    T value{};
+    std::ifstream file{fileName, std::ios::binary};
+    file.seekg(offset);
+    file.read(reinterpret_cast<char*>(&value), sizeof value);
+    return value;
+  }
+
+  template <typename T>
+  void patchAt(std::string const& fileName, std::size_t offset, T const& value)
+  {
+    std::fstream file{fileName, std::ios::in | std::ios::out | std::ios::binary};
+    file.seekp(offset);
+    file.write(reinterpret_cast<char const*>(&value), sizeof value);
+  }
+
+  inline std::size_t fileSize(std::string const& fileName)
+  {
+    return std::ifstream{fileName, std::ios::binary | std::ios::ate}.tellg();
+  }
+
+} // namespace larg4::test
+
+#endif // LARG4_TEST_SERVICES_PATCHFILE_H
@@ -0,0 +1,137 @@
+//=============================================================================
+// RadiologicalLibrary_test.cc: write/read round trip of larg4::RadiologicalLibrary
+//=============================================================================
+
+#define BOOST_TEST_MODULE (RadiologicalLibrary_test)
+#include "boost/test/unit_test.hpp"
+
+#include "larg4/Services/RadiologicalLibrary.h"
+
+#include "PatchFile.h"
+
+#include "cetlib_except/exception.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <unistd.h>
+
+using larg4::RadiologicalLibrary;
+using namespace larg4::test;
+using Header = RadiologicalLibrary::Header;
+using Isotope = RadiologicalLibrary::Isotope;
+using Deposit = RadiologicalLibrary::Deposit;
+
+namespace {
+
+  RadiologicalLibrary::Deposit deposit(float x, float t, float edep, int pdg)
+  {
+    return {{x, 0.f, 0.f}, {x + 0.1f, 0.f, 0.f}, t, t + 1.f, edep, 0.8f, 100, 200, pdg};
+  }
+
+  // Two decays of Ar39, the second one without deposits, one of Rn222 and
+  // none of Kr85
+  RadiologicalLibrary::Content content()
+  {
+    RadiologicalLibrary::Content result;
+    result["Ar39"] = {{deposit(0.f, 0.f, 0.2f, 11), deposit(0.5f, 2.f, 0.1f, 11)}, {}};
+    result["Rn222"] = {{deposit(0.f, 0.f, 5.5f, 1000020040)}};
+    result["Kr85"] = {};
+    return result;
+  }
+
+}
+
+BOOST_AUTO_TEST_CASE(round_trip)
+{
+  std::string const fileName = "round_trip.rad";
+  RadiologicalLibrary::write(fileName, content());
+  RadiologicalLibrary const library{fileName};
+  BOOST_TEST(library.fileName() == fileName);
+
+  auto const& ar39 = library.isotope("Ar39");
+  BOOST_TEST(std::string(ar39.name) == "Ar39");
+  BOOST_TEST_REQUIRE(ar39.nDecays == 2u);
+  auto const first = library.decay(ar39, 0);
+  BOOST_TEST_REQUIRE(std::distance(first.begin, first.end) == 2);
+  auto const& second = first.begin[1];
+  BOOST_TEST(second.start[0] == 0.5f);
+  BOOST_TEST(second.end[0] == 0.6f);
+  BOOST_TEST(second.startT == 2.f);
+  BOOST_TEST(second.endT == 3.f);
+  BOOST_TEST(second.edep == 0.1f);
+  BOOST_TEST(second.scintYieldRatio == 0.8f);
+  BOOST_TEST(second.numPhotons == 100);
+  BOOST_TEST(second.numElectrons == 200);
+  BOOST_TEST(second.pdg == 11);
+  // -- decays without deposits are kept
+  auto const empty = library.decay(ar39, 1);
+  BOOST_TEST(empty.begin == empty.end);
+
+  auto const& rn222 = library.isotope("Rn222");
+  BOOST_TEST_REQUIRE(rn222.nDecays == 1u);
+  BOOST_TEST(library.decay(rn222, 0).begin->pdg == 1000020040);
+
+  // -- isotopes absent or without decays cannot be overlaid
+  BOOST_CHECK_THROW(library.isotope("Kr85"), cet::exception);
+  BOOST_CHECK_THROW(library.isotope("Co60"), cet::exception);
+
+  std::remove(fileName.c_str());
+}
+
+BOOST_AUTO_TEST_CASE(long_isotope_names_are_refused)
+{
+  RadiologicalLibrary::Content content;
+  content[std::string(24, 'X')] = {{}};
+  BOOST_CHECK_THROW(RadiologicalLibrary::write("long_name.rad", content), cet::exception);
+}
+
+BOOST_AUTO_TEST_CASE(foreign_files_are_refused)
+{
+  std::string const fileName = "foreign.rad";
+  std::ofstream{fileName} << "not a radiological library, but long enough for a header";
+  BOOST_CHECK_THROW(RadiologicalLibrary{fileName}, cet::exception);
+  std::remove(fileName.c_str());
+}
+
+BOOST_AUTO_TEST_CASE(other_versions_are_refused)
+{
+  std::string const fileName = "version2.rad";
+  RadiologicalLibrary::write(fileName, content());
+  patchAt(fileName, offsetof(Header, version), std::uint32_t{2});
+  BOOST_CHECK_THROW(RadiologicalLibrary{fileName}, cet::exception);
+  std::remove(fileName.c_str());
+}
+
+BOOST_AUTO_TEST_CASE(deposit_count_must_match_the_decays)
+{
+  std::string const fileName = "deposits.rad";
+  RadiologicalLibrary::write(fileName, content());
+  auto const nDeposits = readAt<std::uint64_t>(fileName, offsetof(Header, nDeposits));
+
+  // -- more deposits announced than stored
+  patchAt(fileName, offsetof(Header, nDeposits), nDeposits + 1);
+  BOOST_CHECK_THROW(RadiologicalLibrary{fileName}, cet::exception);
+
+  // -- the last deposit dropped: the size matches, the Rn222 decay does not
+  patchAt(fileName, offsetof(Header, nDeposits), nDeposits - 1);
+  BOOST_TEST(::truncate(fileName.c_str(), fileSize(fileName) - sizeof(Deposit)) == 0);
+  BOOST_CHECK_THROW(RadiologicalLibrary{fileName}, cet::exception);
+
+  std::remove(fileName.c_str());
+}
+
+BOOST_AUTO_TEST_CASE(unterminated_isotope_names_are_refused)
+{
+  std::string const fileName = "name.rad";
+  RadiologicalLibrary::write(fileName, content());
+  char name[sizeof(Isotope::name)];
+  std::fill(std::begin(name), std::end(name), 'X');
+  patchAt(fileName, sizeof(Header) + offsetof(Isotope, name), name);
+  BOOST_CHECK_THROW(RadiologicalLibrary{fileName}, cet::exception);
+  std::remove(fileName.c_str());
+}
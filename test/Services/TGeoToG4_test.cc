@@ -0,0 +1,110 @@
+//=============================================================================
+// TGeoToG4_test.cc: shapes and properties larg4::TGeoToG4 converts or refuses
+//=============================================================================
+
+#define BOOST_TEST_MODULE (TGeoToG4_test)
+#include "boost/test/unit_test.hpp"
+
+#include "larg4/Services/TGeoToG4.h"
+
+#include "cetlib_except/exception.h"
+
+#include "Geant4/G4LogicalVolume.hh"
+#include "Geant4/G4LogicalVolumeStore.hh"
+#include "Geant4/G4Material.hh"
+#include "Geant4/G4MaterialPropertiesTable.hh"
+#include "Geant4/G4PhysicalVolumeStore.hh"
+#include "Geant4/G4SolidStore.hh"
+#include "Geant4/G4SystemOfUnits.hh"
+#include "Geant4/G4Tubs.hh"
+#include "Geant4/G4VPhysicalVolume.hh"
+
+#include "TGDMLMatrix.h"
+#include "TGeoBBox.h"
+#include "TGeoEltu.h"
+#include "TGeoManager.h"
+#include "TGeoMaterial.h"
+#include "TGeoMedium.h"
+#include "TGeoTube.h"
+#include "TGeoVolume.h"
+
+#include <memory>
+
+namespace {
+
+  // A 1 m world box of `material` holding one volume of `shape`; ROOT units
+  std::unique_ptr<TGeoManager> geometry(TGeoShape* shape, TGeoMaterial* material = nullptr)
+  {
+    auto geo = std::make_unique<TGeoManager>("TGeoToG4_test", "TGeoToG4_test");
+    if (!material) material = new TGeoMaterial("G4_AIR", 14.61, 7.3, 0.0012);
+    auto medium = new TGeoMedium(material->GetName(), 1, material);
+    auto top = new TGeoVolume("volWorld", new TGeoBBox("World", 100., 100., 100.), medium);
+    top->AddNode(new TGeoVolume("volDaughter", shape, medium), 1);
+    geo->SetTopVolume(top);
+    return geo;
+  }
+
+  void clearGeometry()
+  {
+    G4PhysicalVolumeStore::Clean();
+    G4LogicalVolumeStore::Clean();
+    G4SolidStore::Clean();
+  }
+
+}
+
+BOOST_AUTO_TEST_CASE(tube_is_converted)
+{
+  auto geo = geometry(new TGeoTube("Tube", 0., 10., 20.));
+  G4VPhysicalVolume* world = larg4::TGeoToG4{}.convert(*geo);
+  BOOST_TEST_REQUIRE(world->GetLogicalVolume()->GetNoDaughters() == 1u);
+  auto const tube = dynamic_cast<G4Tubs const*>(
+    world->GetLogicalVolume()->GetDaughter(0)->GetLogicalVolume()->GetSolid());
+  BOOST_TEST_REQUIRE(tube != nullptr);
+  BOOST_TEST(tube->GetOuterRadius() == 10. * cm);
+  BOOST_TEST(tube->GetZHalfLength() == 20. * cm);
+  clearGeometry();
+}
+
+// -- these derive from TGeoTube and TGeoTubeSeg, but are not tubes
+BOOST_AUTO_TEST_CASE(derived_shapes_are_refused)
+{
+  {
+    auto geo = geometry(new TGeoEltu("Eltu", 10., 5., 20.));
+    BOOST_CHECK_THROW(larg4::TGeoToG4{}.convert(*geo), cet::exception);
+    clearGeometry();
+  }
+  {
+    auto geo = geometry(new TGeoCtub("Ctub", 0., 10., 20., 0., 360., 0., 0.6, -0.8, 0., 0., 1.));
+    BOOST_CHECK_THROW(larg4::TGeoToG4{}.convert(*geo), cet::exception);
+    clearGeometry();
+  }
+}
+
+BOOST_AUTO_TEST_CASE(only_the_constant_scintillation_yield_is_per_energy)
+{
+  auto lar = new TGeoMaterial("TGeoToG4_test_LAr", 39.95, 18., 1.39);
+  auto geo = geometry(new TGeoBBox("Box", 10., 10., 10.), lar);
+  geo->AddProperty("LArYield", 24.); // photons/GeV
+  lar->AddConstProperty("SCINTILLATIONYIELD", "LArYield");
+  auto protonYield = new TGDMLMatrix("LArProtonYield", 2, 2);
+  protonYield->Set(0, 0, 1e-6); // GeV
+  protonYield->Set(0, 1, 0.5);
+  protonYield->Set(1, 0, 1.);
+  protonYield->Set(1, 1, 0.5);
+  geo->AddGDMLMatrix(protonYield);
+  lar->AddProperty("PROTONSCINTILLATIONYIELD", "LArProtonYield");
+
+  larg4::TGeoToG4{}.convert(*geo);
+  G4Material const* material = G4Material::GetMaterial("TGeoToG4_test_LAr");
+  BOOST_TEST_REQUIRE(material != nullptr);
+  G4MaterialPropertiesTable* mpt = material->GetMaterialPropertiesTable();
+  BOOST_TEST_REQUIRE(mpt != nullptr);
+  BOOST_TEST(mpt->GetConstProperty("SCINTILLATIONYIELD") == 24. / GeV,
+             boost::test_tools::tolerance(1e-12));
+  G4MaterialPropertyVector const* proton = mpt->GetProperty("PROTONSCINTILLATIONYIELD");
+  BOOST_TEST_REQUIRE(proton != nullptr);
+  BOOST_TEST((*proton)[0] == 0.5);
+  BOOST_TEST(proton->Energy(1) == 1. * GeV);
+  clearGeometry();
+}
@@ -0,0 +1,75 @@
+//=============================================================================
+// PrimaryFilter_test.cc: which primaries larg4::PrimaryFilter lets through
+//=============================================================================
+
+#define BOOST_TEST_MODULE (PrimaryFilter_test)
+#include "boost/test/unit_test.hpp"
+
+#include "larg4/pluginActions/PrimaryFilter.h"
+
+#include "Geant4/G4Gamma.hh"
+#include "Geant4/G4Ions.hh"
+#include "Geant4/G4Neutron.hh"
+#include "Geant4/G4Proton.hh"
+#include "Geant4/G4SystemOfUnits.hh"
+
+namespace {
+
+  // A 1 m box at the origin, with the default parameters of the service
+  larg4::PrimaryFilter filter()
+  {
+    return {10. * cm,
+            30. * cm,
+            1. * cm,
+            0.1 * GeV,
+            {{G4ThreeVector(-0.5, -0.5, -0.5) * m, G4ThreeVector(0.5, 0.5, 0.5) * m}}};
+  }
+
+  // Starting 5 m away from the box, heading further away
+  G4ThreeVector const farAway{5. * m, 0., 0.};
+  G4ThreeVector const outwards{1., 0., 0.};
+
+  // A radioactive nucleus in its ground state, flagged stable as
+  // G4IonTable::CreateIon() does when it has no decay table yet
+  G4ParticleDefinition const& cesium137()
+  {
+    static auto const ion = new G4Ions("Cs137_test",
+                                       137. * 931.494 * MeV,
+                                       0.,
+                                       55. * eplus,
+                                       7,
+                                       +1,
+                                       0,
+                                       0,
+                                       0,
+                                       0,
+                                       "nucleus",
+                                       0,
+                                       137,
+                                       1000551370,
+                                       true,
+                                       43.5 * 365.25 * 24. * 3600. * s,
+                                       nullptr,
+                                       false,
+                                       "generic");
+    return *ion;
+  }
+
+}
+
+BOOST_AUTO_TEST_CASE(stable_particles_out_of_reach_are_skipped)
+{
+  auto const f = filter();
+  BOOST_TEST(!f.mayReach(*G4Proton::Definition(), farAway, outwards, 10. * MeV));
+  BOOST_TEST(!f.mayReach(*G4Gamma::Definition(), farAway, outwards, 10. * MeV));
+  // -- a photon heading to the box is kept
+  BOOST_TEST(f.mayReach(*G4Gamma::Definition(), farAway, -outwards, 10. * MeV));
+}
+
+BOOST_AUTO_TEST_CASE(unstable_particles_and_nuclei_are_kept)
+{
+  auto const f = filter();
+  BOOST_TEST(f.mayReach(*G4Neutron::Definition(), farAway, outwards, 1. * MeV));
+  BOOST_TEST_REQUIRE(cesium137().GetPDGStable());
+  BOOST_TEST(f.mayReach(cesium137(), farAway, outwards, 1. * keV));
+}